@@ -0,0 +1,52 @@
+
+/**
+ * Compares the checked and unchecked variants of the hot bindings.
+ *
+ *   $ node bench/checked.js
+ */
+
+var ref = require('../')
+
+var iterations = 5e6
+var buf = Buffer.alloc(64)
+var ptr = ref.alloc('pointer', buf)
+
+function bench (name, fn) {
+  // warm up
+  fn(1e5)
+  var start = process.hrtime.bigint()
+  fn(iterations)
+  var ns = Number(process.hrtime.bigint() - start)
+  return ns / iterations
+}
+
+var cases = {
+  readInt64: function (variant) {
+    return function (n) {
+      for (var i = 0; i < n; i++) variant.readInt64(buf, 8)
+    }
+  },
+  writeInt64: function (variant) {
+    return function (n) {
+      for (var i = 0; i < n; i++) variant.writeInt64(buf, 8, i)
+    }
+  },
+  readPointer: function (variant) {
+    return function (n) {
+      for (var i = 0; i < n; i++) variant.readPointer(ptr, 0, 0)
+    }
+  },
+  readCString: function (variant) {
+    return function (n) {
+      for (var i = 0; i < n; i++) variant.readCString(buf, 0)
+    }
+  }
+}
+
+Object.keys(cases).forEach(function (name) {
+  var unchecked = bench(name, cases[name](ref.unchecked))
+  var checked = bench(name, cases[name](ref.checked))
+  console.log('%s: unchecked %s ns, checked %s ns (%s%%)', name,
+    unchecked.toFixed(1), checked.toFixed(1),
+    ((checked / unchecked - 1) * 100).toFixed(1))
+})
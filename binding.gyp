@@ -1,4 +1,13 @@
 {
+  'variables': {
+    # build with `node-gyp rebuild --ref_stats=true` to compile in the
+    # `ref.stats()` counters
+    'ref_stats%': 'false',
+    # build with `node-gyp rebuild --ref_checked=true` to export the bounds
+    # checked bindings by default
+    'ref_checked%': 'false',
+    'ref_test%': 'false'
+  },
   'targets': [
     {
       'target_name': 'binding',
@@ -7,6 +16,18 @@
         '<!(node -e "require(\'nan\')")'
       ],
       'conditions': [
+        [
+          'ref_stats == "true"',
+          {
+            'defines': [ 'REF_ENABLE_STATS' ]
+          }
+        ],
+        [
+          'ref_checked == "true"',
+          {
+            'defines': [ 'REF_DEFAULT_CHECKED' ]
+          }
+        ],
         [ 
           'OS == "linux"',
           {
@@ -28,5 +49,44 @@
         ]
       ]
     }
+  ],
+  'conditions': [
+    [
+      # `npm test` builds with `node-gyp rebuild --ref_test=true` to add the
+      # native helpers of the test suite
+      'ref_test == "true"',
+      {
+        'targets': [
+          {
+            # native deallocators recording their calls, for test/owned.js
+            'target_name': 'test_deallocator',
+            'sources': [ 'test/deallocator.cc' ],
+            'include_dirs': [
+              '<!(node -e "require(\'nan\')")'
+            ],
+            'conditions': [
+              [
+                'OS == "linux"',
+                {
+                  'cflags': [
+                    '-std=c++20'
+                  ]
+                }
+              ],
+              [
+                'OS == "win"',
+                {
+                  'msvs_settings': {
+                    'VCCLCompilerTool': {
+                      'AdditionalOptions': [ '/std:c++20' ]
+                    }
+                  }
+                }
+              ]
+            ]
+          }
+        ]
+      }
+    ]
   ]
 }
@@ -79,6 +79,22 @@ export class BufferRef extends Buffer {
    */
   writeCString(str: string, offset?: number, encoding?: string):void 
 
+  /**
+   * read wide character string from buffer
+   * @param {number} offset - byte offset to read a string
+   * @param {number=} unitSize - 2 (UTF-16) or 4 (UTF-32), default sizeof.wchar_t
+   * @return {string}
+   */
+  readWString(offset?: number, unitSize?: number): string
+
+  /**
+   * write string into buffer as wide characters
+   * @param {string} str - string to be written into this buffer
+   * @param {number} offset - byte offset to write a string
+   * @param {number=} unitSize - 2 (UTF-16) or 4 (UTF-32), default sizeof.wchar_t
+   */
+  writeWString(str: string, offset?: number, unitSize?: number):void 
+
  /**
   * read 64 bits integer big-endian byte order
   * @param {number} offset - specify byte offset to read from
@@ -49,6 +49,7 @@ export interface TypeBase {
   set(buffer: Buffer, offset: number, val: any): void
   name?: string
   external?: boolean   
+  alignment?: number
 }
 
 
@@ -413,6 +414,45 @@ export function readUInt64LE(buffer: Buffer,
 export function readCString(buffer: Buffer,
   offset: number): string 
 
+/**
+ * Returns a JavaScript String read from _buffer_ at the given _offset_ as
+ * wide characters, up to the first NUL character.
+ *
+ * @param {Buffer} buffer The buffer to read a String from.
+ * @param {number} offset The offset to begin reading from.
+ * @param {number=} unitSize The size in bytes of a character, 2 or 4. Defaults to `sizeof.wchar_t`.
+ * @return {string} The String that was read from _buffer_.
+ */
+export function readWString(buffer: Buffer,
+  offset: number,
+  unitSize?: number): string
+
+/**
+ * Writes the given string as NUL terminated wide characters to the given
+ * buffer at the given offset.
+ *
+ * @param {Buffer} buffer The Buffer instance to write to.
+ * @param {number} offset The offset of the buffer to begin writing at.
+ * @param {string} string The JavaScript String that will be written to the buffer.
+ * @param {number=} unitSize The size in bytes of a character, 2 or 4. Defaults to `sizeof.wchar_t`.
+ */
+export function writeWString(buffer: Buffer,
+  offset: number,
+  str: string,
+  unitSize?: number): void
+
+/**
+ * Returns a new `Buffer` instance with the given String written to it as NUL
+ * terminated wide characters.
+ *
+ * @param {string} string The JavaScript string to be converted to a wide string.
+ * @param {number=} unitSize The size in bytes of a character, 2 or 4. Defaults to `sizeof.wchar_t`.
+ * @return {Buffer} The new `Buffer` instance with a trailing NUL character.
+ */
+export function allocWString(
+  str: string,
+  unitSize?: number): Buffer
+
 /*
  * Returns a new Buffer instance that has the same memory address
  * as the given buffer, but with the specified size.
@@ -444,7 +484,7 @@ export function copyMemory(dst: Buffer,
   size: number): void 
 
 /**
- * add displacement to external pointer
+ * add a 64-bit displacement to external pointer
  */
 export function addOffset(dst: Buffer,
   offset: number): void 
@@ -617,6 +657,22 @@ export function allocCString(
   str: string,
   encoding?: string): Buffer 
 
+/**
+ * Returns a new `Buffer` instance that can be passed as a `char **`. The
+ * Buffer begins with a table of pointers, one per String, followed by all the
+ * NUL terminated C Strings the table points to, in a single allocation.
+ * `null` and `undefined` entries become NULL pointers.
+ *
+ * @param {Array<string | null>} strings The JavaScript strings to be converted to C strings.
+ * @param {string=} encoding The encoding to use for the C strings. Defaults to __'utf8'__.
+ * @param {boolean=} terminate Whether a NULL pointer ends the table. Defaults to _true_.
+ * @return {Buffer} The new `Buffer` instance, with its `type` set to `char **`.
+ */
+export function allocCStringArray(
+  strings: Array<string | null | undefined>,
+  encoding?: string,
+  terminate?: boolean): Buffer
+
 /**
  * Writes the given string as a C String (NULL terminated) to the given buffer
  * at the given offset. "encoding" is optional and defaults to __'utf8'__.
@@ -635,6 +691,107 @@ export function writeCString(
   str: string,
   encoding: string): void
 
+/**
+ * Returns a new Buffer of _size_ bytes allocated on the C heap. Unlike
+ * `Buffer.alloc()` the memory is not zero filled. It is reported to V8 as
+ * external memory, and released when the Buffer gets garbage collected or is
+ * passed to `free()`.
+ *
+ * @param {number} size The size in bytes of the returned Buffer.
+ * @return {Buffer} A new uninitialized Buffer.
+ */
+export function malloc(size: number): Buffer
+
+/**
+ * Same as `malloc()`, but the memory address of the returned Buffer is a
+ * multiple of _alignment_.
+ *
+ * @param {number} size The size in bytes of the returned Buffer.
+ * @param {number} alignment The alignment in bytes. Must be a power of 2.
+ * @return {Buffer} A new uninitialized Buffer.
+ */
+export function alignedAlloc(size: number, alignment: number): Buffer
+
+/**
+ * Releases the memory of a Buffer returned by `malloc()`, `alignedAlloc()`,
+ * `reinterpretOwned()` or `readPointerOwned()` without waiting for the
+ * garbage collector. The Buffer, and every view of it, has a `length` of 0
+ * right away; node runs the deallocator from the next turn of the event loop.
+ *
+ * @param {Buffer} buffer The Buffer instance to release.
+ */
+export function free(buffer: Buffer): void
+
+/**
+ * Same as `reinterpret()`, but the returned Buffer takes ownership of the
+ * native memory and releases it with _deallocator_ once garbage collected or
+ * passed to `free()`. Its size is reported to V8 as external memory.
+ *
+ * @param {Buffer} buffer A Buffer whose address the returned Buffer takes over.
+ * @param {number} size The `length` of the returned Buffer.
+ * @param {number} offset The offset of the Buffer to begin from.
+ * @param {Buffer} deallocator A `void (*)(void *)` function pointer, or
+ *   `void (*)(void *, void *)` when _hint_ is given. Defaults to `free()`.
+ * @param {Buffer} hint The second argument of _deallocator_.
+ * @return {Buffer} A new Buffer instance owning the memory.
+ */
+export function reinterpretOwned(buffer: Buffer, size: number,
+  offset?: number, deallocator?: Buffer | null, hint?: Buffer): Buffer
+
+/**
+ * Same as `readPointer()`, but the returned Buffer takes ownership of the
+ * memory pointed to, like with `reinterpretOwned()`.
+ *
+ * @param {Buffer} buffer The buffer to read a pointer from.
+ * @param {number} offset The offset to begin reading from.
+ * @param {number} size The `length` of the returned Buffer.
+ * @param {Buffer} deallocator The function releasing the memory.
+ * @param {Buffer} hint The second argument of _deallocator_.
+ * @return {Buffer} A new Buffer instance owning the memory.
+ */
+export function readPointerOwned(buffer: Buffer, offset?: number,
+  size?: number, deallocator?: Buffer | null, hint?: Buffer): Buffer
+
+/**
+ * Hands out typed Buffers from a few large native blocks by bumping an
+ * offset. `reset()` makes the whole arena reusable at once.
+ */
+export class Arena {
+  /**
+   * @param {number=} blockSize The size in bytes of each native block. Defaults to 4096.
+   */
+  constructor(blockSize?: number)
+
+  /**
+   * Returns a new Buffer from the arena big enough to hold `type`, with the
+   * given `value` written to it. The memory is not zero filled.
+   *
+   * @param {TypeBase|string} type The "type" object to allocate.
+   * @param {any} value (optional) The initial value set on the returned Buffer.
+   * @return {Buffer} A Buffer from the arena with it's `type` set to "type".
+   */
+  alloc(typeObj: TypeBase | string, value?: any): Buffer
+
+  /**
+   * Returns an untyped Buffer of _size_ bytes from the arena.
+   *
+   * @param {number} size The size in bytes of the returned Buffer.
+   * @param {number=} alignment The alignment in bytes. Defaults to 1.
+   * @return {Buffer} A Buffer from the arena.
+   */
+  allocBytes(size: number, alignment?: number): Buffer
+
+  /**
+   * Makes all the memory of the arena available again.
+   */
+  reset(): void
+
+  /**
+   * Releases the native blocks of the arena.
+   */
+  destroy(): void
+}
+
 /**
  * `ref()` accepts a Buffer instance and returns a new Buffer
  * instance that is "pointer" sized and has its data pointing to the given
@@ -721,6 +878,144 @@ export function reinterpretUntilZeros(
   size: number,
   offset: number): Buffer
 
+/**
+ * a field of a struct array decoded or encoded as a column
+ */
+export interface ColumnField {
+  /**
+   * the offset in bytes of the field in the struct
+   */
+  offset: number
+  /**
+   * one of the built-in number types
+   */
+  type: TypeBase | string
+  /**
+   * the typed array holding the column; created by `readColumns()` if missing
+   */
+  column?: ArrayBufferView
+}
+
+/**
+ * Decodes an array of _count_ structs, _stride_ bytes apart, into one typed
+ * array per field, in a single native pass.
+ *
+ * @param {Buffer} buffer The Buffer pointing to the first struct.
+ * @param {number} offset The offset of the Buffer to begin from.
+ * @param {number} count The number of structs.
+ * @param {number} stride The size in bytes of each struct.
+ * @param {ColumnField[]} fields The fields to decode.
+ * @return {ArrayBufferView[]} The typed array columns, in the order of _fields_.
+ */
+export function readColumns(
+  buffer: Buffer,
+  offset: number,
+  count: number,
+  stride: number,
+  fields: ColumnField[]): ArrayBufferView[]
+
+/**
+ * Encodes the typed array `column` of each field into an array of _count_
+ * structs, _stride_ bytes apart, in a single native pass.
+ *
+ * @param {Buffer} buffer The Buffer pointing to the first struct.
+ * @param {number} offset The offset of the Buffer to begin from.
+ * @param {number} count The number of structs.
+ * @param {number} stride The size in bytes of each struct.
+ * @param {ColumnField[]} fields The fields to encode.
+ */
+export function writeColumns(
+  buffer: Buffer,
+  offset: number,
+  count: number,
+  stride: number,
+  fields: ColumnField[]): void
+
+/**
+ * A movable pointer into a native array of _stride_ sized elements. Fields of
+ * the current element are read and written in place, without allocating.
+ */
+export class Cursor {
+  /**
+   * @param {Buffer} buffer The Buffer pointing to the first element.
+   * @param {number} stride The size in bytes of each element.
+   * @param {number=} count The number of elements. Unbounded if omitted.
+   * @param {number=} offset The offset of the Buffer to begin from.
+   */
+  constructor(buffer: Buffer, stride: number, count?: number, offset?: number)
+
+  /**
+   * move to the next element
+   * @return {boolean} true if the cursor is on an element
+   */
+  next(): boolean
+
+  /**
+   * move by _n_ elements, which may be negative
+   * @return {boolean} true if the cursor is on an element
+   */
+  advance(n: number): boolean
+
+  /**
+   * move to the element at _index_
+   * @return {boolean} true if the cursor is on an element
+   */
+  seek(index: number): boolean
+
+  /**
+   * @return {boolean} true if the cursor is on an element
+   */
+  valid(): boolean
+
+  /**
+   * @return {number} the index of the current element
+   */
+  index(): number
+
+  /**
+   * @return {string} the hexadecimal address of the current element
+   */
+  hexAddress(): string
+
+  readInt8(fieldOffset?: number): number
+  readUInt8(fieldOffset?: number): number
+  readInt16(fieldOffset?: number): number
+  readUInt16(fieldOffset?: number): number
+  readInt32(fieldOffset?: number): number
+  readUInt32(fieldOffset?: number): number
+  readInt64(fieldOffset?: number): number | string
+  readUInt64(fieldOffset?: number): number | string
+  readFloat(fieldOffset?: number): number
+  readDouble(fieldOffset?: number): number
+  readPointer(fieldOffset?: number, size?: number): Buffer
+  readCString(fieldOffset?: number): string | null
+  writeInt8(value: number, fieldOffset?: number): void
+  writeUInt8(value: number, fieldOffset?: number): void
+  writeInt16(value: number, fieldOffset?: number): void
+  writeUInt16(value: number, fieldOffset?: number): void
+  writeInt32(value: number, fieldOffset?: number): void
+  writeUInt32(value: number, fieldOffset?: number): void
+  writeInt64(value: number | string, fieldOffset?: number): void
+  writeUInt64(value: number | string, fieldOffset?: number): void
+  writeFloat(value: number, fieldOffset?: number): void
+  writeDouble(value: number, fieldOffset?: number): void
+}
+
+/**
+ * Returns a new `Cursor` on the first element of a native array.
+ *
+ * @param {Buffer} buffer The Buffer pointing to the first element.
+ * @param {number} stride The size in bytes of each element.
+ * @param {number=} count The number of elements. Unbounded if omitted.
+ * @param {number=} offset The offset of the Buffer to begin from.
+ * @return {Cursor} A new Cursor on the first element.
+ */
+export function cursor(
+  buffer: Buffer,
+  stride: number,
+  count?: number,
+  offset?: number): Cursor
+
 /**
  * read buffer from pointer
  */
@@ -738,6 +1033,60 @@ export function comparePointer(
   offset1?: number,
   offset2?: number): number
 
+/**
+ * native runtime counters of the calling thread
+ */
+export interface Stats {
+  calls: { [binding: string]: number }
+  bytesScanned: number
+  bytesCopied: number
+  wrappedPointers: {
+    live: number
+    liveBytes: number
+    total: number
+  }
+  globalHandles: {
+    created: number
+    collected: number
+  }
+  /**
+   * log2(ns) latency buckets per binding, only in histogram mode
+   */
+  latency?: { [binding: string]: number[] }
+}
+
+/**
+ * Returns a snapshot of the native runtime counters of the calling thread.
+ * The counters exist only when the addon is built with
+ * `node-gyp rebuild --ref_stats=true`.
+ *
+ * @return {Stats | null} the counters, or null when they are compiled out.
+ */
+export function stats(): Stats | null
+
+/**
+ * Zeroes the counters returned by `stats()`.
+ *
+ * @param {boolean=} histogram - turn the latency histogram on or off.
+ */
+export function resetStats(histogram?: boolean): void
+
+/**
+ * the native bindings accessing a Buffer at an offset, by name
+ */
+export type NativeBindings = { [name: string]: (...args: any[]) => any }
+
+/**
+ * The bindings validating that every access lies within the Buffer's
+ * `length` and is properly aligned, throwing a RangeError otherwise.
+ */
+export const checked: NativeBindings
+
+/**
+ * The bindings trusting the given offset.
+ */
+export const unchecked: NativeBindings
+
 export const types: Types
 
 
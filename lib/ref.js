@@ -2,8 +2,50 @@ var assert = require('assert')
 var inspect = require('util').inspect
 var debug = require('debug')('ref')
 
+/*!
+ * The `debug()` calls on hot paths are guarded by `debug.enabled`, so that
+ * their arguments aren't even evaluated when logging is off. That's unrelated
+ * to the native trace events: for timing the native side, run node with
+ * `--trace-event-categories ref` and load the resulting trace file into
+ * `chrome://tracing`.
+ */
+
 exports = module.exports = require('bindings')('binding')
 
+/**
+ * The native bindings that access a Buffer at an offset exist in two
+ * variants. `ref.checked` holds the ones validating that every access lies
+ * within the Buffer's `length` and is properly aligned, throwing a precise
+ * `RangeError` otherwise. `ref.unchecked` holds the ones trusting the offset.
+ * The checked `readCString()`, `readWString()` and `reinterpretUntilZeros()`
+ * throw if no terminator lies within the Buffer, unless its `length` is 0,
+ * as for a pointer to memory of unknown size.
+ *
+ * The module level functions use the unchecked variant, unless the addon was
+ * built with `node-gyp rebuild --ref_checked=true`. Setting `REF_CHECKED=1`
+ * (or `REF_CHECKED=0`) in the environment overrides that choice when the
+ * module loads. Individual call sites may use either object directly; their
+ * functions attach the Buffers they reference just like the module level
+ * ones.
+ *
+ * ```
+ * ref.checked.readInt64(Buffer.alloc(4), 0);
+ * RangeError: readInt64: offset 0 + 8 bytes is out of bounds of a 4 byte Buffer
+ * ```
+ *
+ * @name checked
+ * @type Object
+ */
+
+if (process.env.REF_CHECKED) {
+  var variant = /^(0|false|no)$/i.test(process.env.REF_CHECKED)
+    ? exports.unchecked
+    : exports.checked
+  Object.keys(variant).forEach(function (name) {
+    exports[name] = variant[name]
+  })
+}
+
 /**
  * A `Buffer` that references the C NULL pointer. That is, its memory address
  * points to 0. Its `length` is 0 because accessing any data from this buffer
@@ -131,6 +173,41 @@ exports = module.exports = require('bindings')('binding')
  * @type method
  */
 
+/**
+ * Returns a JavaScript String read from _buffer_ at the given _offset_ as
+ * wide characters (`wchar_t`), up to the first NUL character. The unit size
+ * defaults to `ref.sizeof.wchar_t`; pass 2 for UTF-16 or 4 for UTF-32.
+ *
+ * This function can read beyond the `length` of a Buffer.
+ *
+ * ```
+ * var buf = ref.allocWString('hello');
+ *
+ * console.log(ref.readWString(buf, 0));
+ * 'hello'
+ * ```
+ *
+ * @param {Buffer} buffer The buffer to read a String from.
+ * @param {Number} offset The offset to begin reading from.
+ * @param {Number} unitSize (optional) The size in bytes of a character, 2 or 4. Defaults to `sizeof.wchar_t`.
+ * @return {String} The String that was read from _buffer_.
+ * @name readWString
+ * @type method
+ */
+
+/**
+ * Writes the given string as NUL terminated wide characters to the given
+ * buffer at the given offset. Like `writeCString()`, this function requires
+ * the buffer to actually have the proper length.
+ *
+ * @param {Buffer} buffer The Buffer instance to write to.
+ * @param {Number} offset The offset of the buffer to begin writing at.
+ * @param {String} string The JavaScript String that will be written to the buffer.
+ * @param {Number} unitSize (optional) The size in bytes of a character, 2 or 4. Defaults to `sizeof.wchar_t`.
+ * @name writeWString
+ * @type method
+ */
+
 /**
  * Returns a big-endian signed 64-bit int read from _buffer_ at the given
  * _offset_.
@@ -431,7 +508,7 @@ exports.getType = function getType (buffer) {
       throw new Error('unknown "type"; cannot set()')
     }
   }
-  debug('getType')
+  if (debug.enabled) debug('getType')
   return exports.coerceType(buffer.type)
 }
 
@@ -458,7 +535,7 @@ exports.get = function get (buffer, offset, type) {
   } else {
     srcType = exports.getType(buffer)
   }
-  debug('get(): (offset: %d)', offset, buffer)
+  if (debug.enabled) debug('get(): (offset: %d)', offset, buffer)
   assert(srcType.indirection > 0, '"indirection" level must be at least 1')
   if (srcType.indirection === 1) {
     // need to check "type"
@@ -512,7 +589,7 @@ exports.set = function set (buffer, offset, value, type) {
   } else {
     type = exports.getType(buffer)
   }
-  debug('set(): (offset: %d)', offset, buffer, value)
+  if (debug.enabled) debug('set(): (offset: %d)', offset, buffer, value)
   assert(type.indirection >= 1, '"indirection" level must be at least 1')
   if (type.indirection === 1) {
     type.set(buffer, offset, value)
@@ -539,7 +616,7 @@ exports.set = function set (buffer, offset, value, type) {
 
 exports.alloc = function alloc (_type, value) {
   var type = exports.coerceType(_type)
-  debug('allocating Buffer for type with "size"', type.size)
+  if (debug.enabled) debug('allocating Buffer for type with "size"', type.size)
   var size
   if (type.indirection === 1) {
     size = type.size
@@ -549,7 +626,7 @@ exports.alloc = function alloc (_type, value) {
   var buffer = Buffer.alloc(size)
   buffer.type = type
   if (arguments.length >= 2) {
-    debug('setting value on allocated buffer', value)
+    if (debug.enabled) debug('setting value on allocated buffer', value)
     exports.set(buffer, 0, value, type)
   }
   return buffer
@@ -580,7 +657,42 @@ exports.allocCString = function allocCString (string, encoding) {
   var buffer = Buffer.alloc(size)
   exports.writeCString(buffer, 0, string, encoding)
   buffer.type = charPtrType
-  debug('allocCString')
+  if (debug.enabled) debug('allocCString')
+  return buffer
+}
+
+/**
+ * Same as `ref.allocCStringArray()`, except that this version does not set
+ * the `type` of the returned Buffer.
+ *
+ * @api private
+ */
+
+exports._allocCStringArray = exports.allocCStringArray
+
+/**
+ * Returns a new `Buffer` instance that can be passed as a `char **`. The
+ * Buffer begins with a table of pointers, one per String, followed by all the
+ * NUL terminated C Strings the table points to. Everything is laid out in a
+ * single allocation, so only the returned Buffer has to be kept alive.
+ * `null` and `undefined` entries become NULL pointers.
+ *
+ * ```
+ * var argv = ref.allocCStringArray([ 'ls', '-l' ]);
+ *
+ * console.log(argv.deref().readCString());
+ * 'ls'
+ * ```
+ *
+ * @param {Array} strings The JavaScript strings to be converted to C strings.
+ * @param {String} encoding (optional) The encoding to use for the C strings. Defaults to __'utf8'__.
+ * @param {Boolean} terminate (optional) Whether a NULL pointer ends the table. Defaults to _true_.
+ * @return {Buffer} The new `Buffer` instance, with its `type` set to `char **`.
+ */
+
+exports.allocCStringArray = function allocCStringArray (strings, encoding, terminate) {
+  var buffer = exports._allocCStringArray(strings, encoding, terminate)
+  buffer.type = charPtrPtrType
   return buffer
 }
 
@@ -611,6 +723,349 @@ exports.writeCString = function writeCString (buffer, offset, string, encoding)
   buffer.writeUInt8(0, offset + len)  // NUL terminate
 }
 
+/**
+ * Same as `ref.allocWString()`, except that this version does not handle
+ * `null` and does not set the `type` of the returned Buffer.
+ *
+ * @api private
+ */
+
+exports._allocWString = exports.allocWString
+
+/**
+ * Returns a new `Buffer` instance with the given String written to it as NUL
+ * terminated wide characters (`wchar_t`).
+ *
+ * ```
+ * var buf = ref.allocWString('hello');
+ *
+ * console.log(buf.length === 6 * ref.sizeof.wchar_t);
+ * true
+ * ```
+ *
+ * @param {String} string The JavaScript string to be converted to a wide string.
+ * @param {Number} unitSize (optional) The size in bytes of a character, 2 or 4. Defaults to `sizeof.wchar_t`.
+ * @return {Buffer} The new `Buffer` instance with the specified String written to it, and a trailing NUL character.
+ */
+
+exports.allocWString = function allocWString (string, unitSize) {
+  if (null == string || (Buffer.isBuffer(string) && exports.isNull(string))) {
+    return exports.NULL
+  }
+  var buffer = exports._allocWString(string, unitSize)
+  if (!unitSize || unitSize === exports.sizeof.wchar_t) {
+    buffer.type = wcharPtrType
+  } else {
+    buffer.type = exports.refType(exports.types['uint' + (unitSize * 8)])
+  }
+  return buffer
+}
+
+/*!
+ * Buffers that own their native memory, handed out by `malloc()`,
+ * `alignedAlloc()`, `reinterpretOwned()` and `readPointerOwned()`; only those
+ * may be passed to `free()`.
+ */
+
+var nativeAllocations = new WeakSet()
+
+/**
+ * Same as `ref.malloc()`, except that this version does not register the
+ * Buffer for `ref.free()`.
+ *
+ * @api private
+ */
+
+exports._malloc = exports.malloc
+
+/**
+ * Returns a new Buffer of _size_ bytes allocated on the C heap. Unlike
+ * `Buffer.alloc()` the memory is not zero filled. It is reported to V8 as
+ * external memory, and released when the Buffer gets garbage collected or is
+ * passed to `ref.free()`.
+ *
+ * ```
+ * var buf = ref.malloc(64);
+ * // ... hand it to native code ...
+ * ref.free(buf);
+ * ```
+ *
+ * @param {Number} size The size in bytes of the returned Buffer.
+ * @return {Buffer} A new uninitialized Buffer.
+ */
+
+exports.malloc = function malloc (size) {
+  var buffer = exports._malloc(size)
+  nativeAllocations.add(buffer)
+  return buffer
+}
+
+/**
+ * Same as `ref.alignedAlloc()`, except that this version does not register the
+ * Buffer for `ref.free()`.
+ *
+ * @api private
+ */
+
+exports._alignedAlloc = exports.alignedAlloc
+
+/**
+ * Same as `ref.malloc()`, but the memory address of the returned Buffer is a
+ * multiple of _alignment_.
+ *
+ * @param {Number} size The size in bytes of the returned Buffer.
+ * @param {Number} alignment The alignment in bytes. Must be a power of 2.
+ * @return {Buffer} A new uninitialized Buffer.
+ */
+
+exports.alignedAlloc = function alignedAlloc (size, alignment) {
+  var buffer = exports._alignedAlloc(size, alignment)
+  nativeAllocations.add(buffer)
+  return buffer
+}
+
+/**
+ * Same as `ref.free()`, except that this version accepts any Buffer, which
+ * is potentially unsafe for pooled or shared Buffers.
+ *
+ * @api private
+ */
+
+exports._free = exports.free
+
+/**
+ * Releases the memory of a Buffer returned by `ref.malloc()`,
+ * `ref.alignedAlloc()`, `ref.reinterpretOwned()` or `ref.readPointerOwned()`
+ * without waiting for the garbage collector. The Buffer, and every view of
+ * it, has a `length` of 0 right away; node runs the deallocator from the
+ * next turn of the event loop.
+ *
+ * @param {Buffer} buffer The Buffer instance to release.
+ */
+
+exports.free = function free (buffer) {
+  if (!nativeAllocations.has(buffer)) {
+    throw new TypeError('free: Buffer does not own its memory')
+  }
+  nativeAllocations.delete(buffer)
+  exports._free(buffer)
+}
+
+/**
+ * Same as `ref.reinterpretOwned()`, except that this version does not
+ * register the Buffer for `ref.free()`.
+ *
+ * @api private
+ */
+
+exports._reinterpretOwned = exports.reinterpretOwned
+
+/**
+ * Same as `ref.reinterpret()`, but the returned Buffer takes ownership of the
+ * native memory at _buffer_'s address. Once it gets garbage collected, or is
+ * passed to `ref.free()`, the memory is released with _deallocator_. Until
+ * then its _size_ is reported to V8 as external memory, so the garbage
+ * collector sees how much native memory the Buffer keeps alive.
+ *
+ * _deallocator_ is a Buffer pointing to a `void (*)(void *)` function, like
+ * one looked up from a shared library. It defaults to the C library's
+ * `free()`. When _hint_ is given, the deallocator is called as
+ * `void (*)(void *data, void *hint)` with _hint_'s address instead.
+ *
+ * ```
+ * var str = libc.strdup('hello');
+ * var buf = ref.reinterpretOwned(str, 6);
+ * ```
+ *
+ * @param {Buffer} buffer A Buffer instance whose address the returned Buffer takes over.
+ * @param {Number} size The `length` property of the returned Buffer.
+ * @param {Number} offset (optional) The offset of the Buffer to begin from.
+ * @param {Buffer} deallocator (optional) The function releasing the memory. Defaults to `free()`.
+ * @param {Buffer} hint (optional) The second argument of _deallocator_.
+ * @return {Buffer} A new Buffer instance owning the memory.
+ */
+
+exports.reinterpretOwned = wrapReinterpretOwned(exports._reinterpretOwned)
+
+function wrapReinterpretOwned (_reinterpretOwned) {
+  return function reinterpretOwned (buffer, size, offset, deallocator, hint) {
+    var rtn = _reinterpretOwned(buffer, size, offset || 0,
+      deallocator || null, hint)
+    nativeAllocations.add(rtn)
+    return rtn
+  }
+}
+
+/**
+ * Same as `ref.readPointerOwned()`, except that this version does not
+ * register the Buffer for `ref.free()`.
+ *
+ * @api private
+ */
+
+exports._readPointerOwned = exports.readPointerOwned
+
+/**
+ * Same as `ref.readPointer()`, but the returned Buffer takes ownership of the
+ * memory that the pointer read from _buffer_ points to. It is released with
+ * _deallocator_ just like with `ref.reinterpretOwned()`. A `NULL` pointer
+ * returns a `NULL` Buffer that owns nothing.
+ *
+ * ```
+ * // char *result; get_result(&result);
+ * var out = ref.alloc('pointer');
+ * lib.get_result(out);
+ * var result = ref.readPointerOwned(out, 0, 128, lib.release_result);
+ * ```
+ *
+ * @param {Buffer} buffer The buffer to read a pointer from.
+ * @param {Number} offset The offset to begin reading from.
+ * @param {Number} size The `length` of the returned Buffer.
+ * @param {Buffer} deallocator (optional) The function releasing the memory. Defaults to `free()`.
+ * @param {Buffer} hint (optional) The second argument of _deallocator_.
+ * @return {Buffer} A new Buffer instance owning the memory.
+ */
+
+exports.readPointerOwned = wrapReadPointerOwned(exports._readPointerOwned)
+
+function wrapReadPointerOwned (_readPointerOwned) {
+  return function readPointerOwned (buffer, offset, size, deallocator, hint) {
+    var rtn = _readPointerOwned(buffer, offset || 0, size || 0,
+      deallocator || null, hint)
+    if (!exports.isNull(rtn)) {
+      nativeAllocations.add(rtn)
+    }
+    return rtn
+  }
+}
+
+/**
+ * An `Arena` hands out typed Buffers from a few large native blocks by
+ * bumping an offset, honouring each type's `alignment`. `reset()` makes the
+ * whole arena reusable at once, so per-request scratch memory costs no
+ * allocation after warm up.
+ *
+ * Buffers returned before a `reset()` alias the ones returned after it, so
+ * they must not be used anymore. `destroy()` releases the native blocks.
+ *
+ * ```
+ * var arena = new ref.Arena(4096);
+ * var count = arena.alloc(ref.types.int, 0);
+ * var name = arena.alloc('pointer');
+ * // ... native calls ...
+ * arena.reset();
+ * ```
+ *
+ * @param {Number} blockSize (optional) The size in bytes of each native block. Defaults to 4096.
+ * @constructor
+ */
+
+function Arena (blockSize) {
+  if (!(this instanceof Arena)) {
+    return new Arena(blockSize)
+  }
+  this.blockSize = blockSize || 4096
+  this.blocks = []
+  this.addresses = []
+  this.index = -1
+  this.offset = 0
+}
+exports.Arena = Arena
+
+/**
+ * Returns a new Buffer from the arena big enough to hold `type`, with the
+ * given `value` written to it. The memory is not zero filled.
+ *
+ * @param {Object|String} type The "type" object to allocate. Strings get coerced first.
+ * @param {?} value (optional) The initial value set on the returned Buffer, using _type_'s `set()` function.
+ * @return {Buffer} A Buffer from the arena with it's `type` set to "type".
+ */
+
+Arena.prototype.alloc = function alloc (_type, value) {
+  var type = exports.coerceType(_type)
+  var size, alignment
+  if (type.indirection === 1) {
+    size = type.size
+    alignment = type.alignment || 1
+  } else {
+    size = exports.sizeof.pointer
+    alignment = exports.alignof.pointer
+  }
+  var buffer = this.allocBytes(size, alignment)
+  buffer.type = type
+  if (arguments.length >= 2) {
+    exports.set(buffer, 0, value, type)
+  }
+  return buffer
+}
+
+/**
+ * Returns an untyped Buffer of _size_ bytes from the arena.
+ *
+ * @param {Number} size The size in bytes of the returned Buffer.
+ * @param {Number} alignment (optional) The alignment in bytes. Defaults to 1.
+ * @return {Buffer} A Buffer from the arena.
+ */
+
+Arena.prototype.allocBytes = function allocBytes (size, alignment) {
+  alignment = alignment || 1
+  var block = this.blocks[this.index]
+  var offset = block ? this.alignOffset(this.offset, alignment) : 0
+  while (!block || offset + size > block.length) {
+    this.index++
+    if (this.index === this.blocks.length) {
+      block = exports.alignedAlloc(Math.max(this.blockSize, size),
+        Math.max(maxAlignment, alignment))
+      this.blocks.push(block)
+      this.addresses.push(exports.address(block))
+    }
+    block = this.blocks[this.index]
+    offset = this.alignOffset(0, alignment)
+  }
+  this.offset = offset + size
+  return block.subarray(offset, offset + size)
+}
+
+/*!
+ * Rounds _offset_ into the current block up so that its absolute address is
+ * a multiple of _alignment_; the blocks themselves may be less aligned.
+ */
+
+Arena.prototype.alignOffset = function alignOffset (offset, alignment) {
+  var address = this.addresses[this.index] + offset
+  return offset + (alignment - address % alignment) % alignment
+}
+
+/**
+ * Makes all the memory of the arena available again. The native blocks are
+ * kept for the next allocations.
+ */
+
+Arena.prototype.reset = function reset () {
+  this.index = this.blocks.length ? 0 : -1
+  this.offset = 0
+}
+
+/**
+ * Releases the native blocks of the arena. Every Buffer returned by it has a
+ * `length` of 0 afterwards.
+ */
+
+Arena.prototype.destroy = function destroy () {
+  this.blocks.forEach(exports.free)
+  this.blocks = []
+  this.addresses = []
+  this.reset()
+}
+
+/*!
+ * The alignment of the arena blocks; enough for every built-in type.
+ */
+
+var maxAlignment = Object.keys(exports.alignof).reduce(function (max, name) {
+  return Math.max(max, exports.alignof[name])
+}, 1)
+
 exports['readInt64' + exports.endianness] = exports.readInt64
 exports['readUInt64' + exports.endianness] = exports.readUInt64
 exports['writeInt64' + exports.endianness] = exports.writeInt64
@@ -661,7 +1116,7 @@ exports['writeUInt64' + opposite] = function (buffer, offset, value) {
  */
 
 exports.ref = function ref (buffer) {
-  debug('creating a reference to buffer', buffer)
+  if (debug.enabled) debug('creating a reference to buffer', buffer)
   var type = exports.refType(exports.getType(buffer))
   return exports.alloc(type, buffer)
 }
@@ -689,7 +1144,7 @@ exports.ref = function ref (buffer) {
  */
 
 exports.deref = function deref (buffer) {
-  debug('dereferencing buffer', buffer)
+  if (debug.enabled) debug('dereferencing buffer', buffer)
   return exports.get(buffer)
 }
 
@@ -739,10 +1194,14 @@ exports._writeObject = exports.writeObject
  * @param {Object} object The Object to be written into _buffer_.
  */
 
-exports.writeObject = function writeObject (buf, offset, obj, persistent) {
-  debug('writing Object to buffer', buf, offset, obj, persistent)
-  exports._writeObject(buf, offset, obj, persistent)
-  exports._attach(buf, obj)
+exports.writeObject = wrapWriteObject(exports._writeObject)
+
+function wrapWriteObject (_writeObject) {
+  return function writeObject (buf, offset, obj, persistent) {
+    if (debug.enabled) debug('writing Object to buffer', buf, offset, obj, persistent)
+    _writeObject(buf, offset, obj, persistent)
+    exports._attach(buf, obj)
+  }
 }
 
 /**
@@ -775,10 +1234,14 @@ exports._writePointer = exports.writePointer
  * @param {Buffer} pointer The Buffer instance whose memory address will be written to _buffer_.
  */
 
-exports.writePointer = function writePointer (buf, offset, ptr, external) {
-  debug('writing pointer to buffer', buf, offset, ptr, external)
-  exports._writePointer(buf, offset, ptr, external)
-  exports._attach(buf, ptr)
+exports.writePointer = wrapWritePointer(exports._writePointer)
+
+function wrapWritePointer (_writePointer) {
+  return function writePointer (buf, offset, ptr, external) {
+    if (debug.enabled) debug('writing pointer to buffer', buf, offset, ptr, external)
+    _writePointer(buf, offset, ptr, external)
+    exports._attach(buf, ptr)
+  }
 }
 
 /**
@@ -808,11 +1271,15 @@ exports._reinterpret = exports.reinterpret
  * @return {Buffer} A new Buffer instance with the same memory address as _buffer_, and the requested _size_.
  */
 
-exports.reinterpret = function reinterpret (buffer, size, offset) {
-  debug('reinterpreting buffer to "%d" bytes', size)
-  var rtn = exports._reinterpret(buffer, size, offset || 0)
-  exports._attach(rtn, buffer)
-  return rtn
+exports.reinterpret = wrapReinterpret(exports._reinterpret)
+
+function wrapReinterpret (_reinterpret) {
+  return function reinterpret (buffer, size, offset) {
+    if (debug.enabled) debug('reinterpreting buffer to "%d" bytes', size)
+    var rtn = _reinterpret(buffer, size, offset || 0)
+    exports._attach(rtn, buffer)
+    return rtn
+  }
 }
 
 /**
@@ -852,11 +1319,226 @@ exports._reinterpretUntilZeros = exports.reinterpretUntilZeros
  * @return {Buffer} A new Buffer instance with the same memory address as _buffer_, and a variable `length` that is terminated by _size_ NUL bytes.
  */
 
-exports.reinterpretUntilZeros = function reinterpretUntilZeros (buffer, size, offset) {
-  debug('reinterpreting buffer to until "%d" NULL (0) bytes are found', size)
-  var rtn = exports._reinterpretUntilZeros(buffer, size, offset || 0)
-  exports._attach(rtn, buffer)
-  return rtn
+exports.reinterpretUntilZeros = wrapReinterpretUntilZeros(exports._reinterpretUntilZeros)
+
+function wrapReinterpretUntilZeros (_reinterpretUntilZeros) {
+  return function reinterpretUntilZeros (buffer, size, offset) {
+    if (debug.enabled) debug('reinterpreting buffer to until "%d" NULL (0) bytes are found', size)
+    var rtn = _reinterpretUntilZeros(buffer, size, offset || 0)
+    exports._attach(rtn, buffer)
+    return rtn
+  }
+}
+
+/*!
+ * The typed array used for a column of each built-in fixed size type. The
+ * variable sized types inherit from one of these.
+ */
+
+var columnArrays = {
+    int8: Int8Array
+  , uint8: Uint8Array
+  , int16: Int16Array
+  , uint16: Uint16Array
+  , int32: Int32Array
+  , uint32: Uint32Array
+  , int64: BigInt64Array
+  , uint64: BigUint64Array
+  , float: Float32Array
+  , double: Float64Array
+}
+
+/*!
+ * Returns the typed array constructor for a column of the given "type".
+ */
+
+function columnArrayType (type) {
+  var _type = exports.coerceType(type)
+  if (_type.indirection === 1) {
+    for (var t = _type; t; t = Object.getPrototypeOf(t)) {
+      if (columnArrays.hasOwnProperty(t.name) && t === types[t.name]) {
+        return columnArrays[t.name]
+      }
+    }
+  }
+  throw new TypeError('no column type for "' + _type.name + '"')
+}
+
+/*!
+ * Binds each `{ offset, type, column }` field to its typed array, creating
+ * the missing ones, as the `[offset, column]` pairs the bindings expect.
+ * Throws a RangeError for a field that doesn't fit in a _stride_ byte struct.
+ */
+
+function bindColumns (fields, count, stride) {
+  return fields.map(function (field) {
+    var ArrayType = columnArrayType(field.type)
+    var offset = field.offset || 0
+    if (!Number.isInteger(offset) || offset < 0 ||
+        offset + ArrayType.BYTES_PER_ELEMENT > stride) {
+      throw new RangeError('field "' + exports.coerceType(field.type).name +
+        '" at offset ' + offset + ' does not fit in a ' + stride + ' byte struct')
+    }
+    var column = field.column
+    if (!column) {
+      column = new ArrayType(count)
+    } else if (!(column instanceof ArrayType)) {
+      throw new TypeError('expected a ' + ArrayType.name + ' column for "' +
+        exports.coerceType(field.type).name + '"')
+    }
+    return [ offset, column ]
+  })
+}
+
+/**
+ * Same as `ref.readColumns()`, except that this version takes
+ * `[offset, TypedArray]` pairs and does not check the column types.
+ *
+ * @api private
+ */
+
+exports._readColumns = exports.readColumns
+
+/**
+ * Decodes an array of _count_ structs, _stride_ bytes apart, into one typed
+ * array per field, in a single native pass. Each field is an Object with the
+ * `offset` of the field in the struct and its `type`, one of the built-in
+ * number types. A preallocated `column` typed array may be given, otherwise
+ * one is created. 64-bit types are decoded into `BigInt64Array` and
+ * `BigUint64Array` columns.
+ *
+ * ```
+ * // struct point { int32_t x; double y; }
+ * var cols = ref.readColumns(points, 0, count, 16, [
+ *   { offset: 0, type: ref.types.int32 },
+ *   { offset: 8, type: ref.types.double }
+ * ]);
+ * console.log(cols[0] instanceof Int32Array, cols[1] instanceof Float64Array);
+ * true true
+ * ```
+ *
+ * This function can read beyond the `length` of a Buffer.
+ *
+ * @param {Buffer} buffer The Buffer pointing to the first struct.
+ * @param {Number} offset The offset of the Buffer to begin from.
+ * @param {Number} count The number of structs.
+ * @param {Number} stride The size in bytes of each struct.
+ * @param {Array} fields The `{ offset, type, column }` fields to decode.
+ * @return {Array} The typed array columns, in the order of _fields_.
+ */
+
+exports.readColumns = wrapReadColumns(exports._readColumns)
+
+function wrapReadColumns (_readColumns) {
+  return function readColumns (buffer, offset, count, stride, fields) {
+    var columns = bindColumns(fields, count, stride)
+    _readColumns(buffer, offset || 0, count, stride, columns)
+    return columns.map(function (pair) {
+      return pair[1]
+    })
+  }
+}
+
+/**
+ * Same as `ref.writeColumns()`, except that this version takes
+ * `[offset, TypedArray]` pairs and does not check the column types.
+ *
+ * @api private
+ */
+
+exports._writeColumns = exports.writeColumns
+
+/**
+ * The reverse of `ref.readColumns()`: encodes the typed array `column` of
+ * each field into an array of _count_ structs, _stride_ bytes apart.
+ *
+ * This function can write beyond the `length` of a Buffer.
+ *
+ * @param {Buffer} buffer The Buffer pointing to the first struct.
+ * @param {Number} offset The offset of the Buffer to begin from.
+ * @param {Number} count The number of structs.
+ * @param {Number} stride The size in bytes of each struct.
+ * @param {Array} fields The `{ offset, type, column }` fields to encode.
+ */
+
+exports.writeColumns = wrapWriteColumns(exports._writeColumns)
+
+function wrapWriteColumns (_writeColumns) {
+  return function writeColumns (buffer, offset, count, stride, fields) {
+    fields.forEach(function (field) {
+      assert(field.column, 'expected a "column" for each field')
+    })
+    _writeColumns(buffer, offset || 0, count, stride, bindColumns(fields, count, stride))
+  }
+}
+
+/*!
+ * The wrappers that the module level functions add on top of their native
+ * binding, to attach the Buffers they reference or register the Buffers
+ * they own.
+ */
+
+var variantWrappers = {
+    writeObject: wrapWriteObject
+  , writePointer: wrapWritePointer
+  , reinterpret: wrapReinterpret
+  , reinterpretUntilZeros: wrapReinterpretUntilZeros
+  , reinterpretOwned: wrapReinterpretOwned
+  , readPointerOwned: wrapReadPointerOwned
+  , readColumns: wrapReadColumns
+  , writeColumns: wrapWriteColumns
+}
+
+/*!
+ * Returns the `ref.checked` or `ref.unchecked` object for the given native
+ * variant, with the same wrappers as the module level functions so that
+ * using it directly is just as safe.
+ */
+
+function wrapVariant (natives) {
+  var variant = {}
+  Object.keys(natives).forEach(function (name) {
+    variant[name] = variantWrappers.hasOwnProperty(name)
+      ? variantWrappers[name](natives[name])
+      : natives[name]
+  })
+  return variant
+}
+
+exports.checked = wrapVariant(exports.checked)
+exports.unchecked = wrapVariant(exports.unchecked)
+
+/**
+ * `Cursor` is a movable pointer into a native array of _stride_ sized
+ * elements. It keeps a 64-bit position, and reads or writes the fields of the
+ * current element in place, so walking an array does not create a Buffer per
+ * element. When _count_ is given, every access is checked against the end of
+ * the array. The cursor keeps _buffer_ alive.
+ *
+ * ```
+ * // struct record { int32_t id; double value; }
+ * var cursor = ref.cursor(records, 16, count);
+ * for (; cursor.valid(); cursor.next()) {
+ *   sum += cursor.readDouble(8);
+ * }
+ * ```
+ *
+ * Besides `next()`, `advance(n)`, `seek(index)`, `valid()`, `index()` and
+ * `hexAddress()`, a cursor has `read*(fieldOffset)` and
+ * `write*(value, fieldOffset)` methods for the `Int8`, `UInt8`, `Int16`,
+ * `UInt16`, `Int32`, `UInt32`, `Int64`, `UInt64`, `Float` and `Double`
+ * machine-endian types, plus `readPointer(fieldOffset, size)` and
+ * `readCString(fieldOffset)`.
+ *
+ * @param {Buffer} buffer The Buffer pointing to the first element.
+ * @param {Number} stride The size in bytes of each element.
+ * @param {Number} count (optional) The number of elements. Unbounded if omitted.
+ * @param {Number} offset (optional) The offset of the Buffer to begin from.
+ * @return {Cursor} A new Cursor on the first element.
+ */
+
+exports.cursor = function cursor (buffer, stride, count, offset) {
+  return new exports.Cursor(buffer, stride, count, offset || 0)
 }
 
 /**
@@ -869,9 +1551,11 @@ exports.readFromPointer = function(pointerBuffer, offset, size) {
     result = Buffer.alloc(size)
     const dstContainer = Buffer.alloc(exports.sizeof.pointer)
     dstContainer.writePointer(result)
-    exports.addOffset(pointerBuffer, offset)
-    exports.copyMemory(dstContainer, pointerBuffer, size) 
-    exports.addOffset(pointerBuffer, -offset) 
+    // offset a copy of the pointer so that "pointerBuffer" is left untouched
+    const srcContainer = Buffer.alloc(exports.sizeof.pointer)
+    pointerBuffer.copy(srcContainer, 0, 0, exports.sizeof.pointer)
+    exports.addOffset(srcContainer, offset)
+    exports.copyMemory(dstContainer, srcContainer, size)
   }
   return result
 }
@@ -914,11 +1598,11 @@ types.void = {
     size: 0
   , indirection: 1
   , get: function get (buf, offset) {
-      debug('getting `void` type (returns `null`)')
+      if (debug.enabled) debug('getting `void` type (returns `null`)')
       return null
     }
   , set: function set (buf, offset, val) {
-      debug('setting `void` type (no-op)')
+      if (debug.enabled) debug('setting `void` type (no-op)')
     }
 }
 
@@ -1282,6 +1966,18 @@ Object.keys(exports.types).forEach(function (name) {
 
 var charPtrType = exports.refType(exports.types.char)
 
+/*!
+ * This `wchar_t *` type is used by "allocWString()" above.
+ */
+
+var wcharPtrType = exports.refType(exports.types.wchar_t)
+
+/*!
+ * This `char **` type is used by "allocCStringArray()" above.
+ */
+
+var charPtrPtrType = exports.refType(charPtrType)
+
 /*!
  * Set the `type` property of the `NULL` pointer Buffer object.
  */
@@ -1340,6 +2036,43 @@ exports.containsNullPointer = function(buf, offset) {
 
 }
 
+/**
+ * Returns a snapshot of the native runtime counters of the calling thread:
+ * per-binding call counts, bytes scanned by `reinterpretUntilZeros()`, bytes
+ * copied by `copyMemory()`, live wrapped pointer Buffers and the global handles
+ * created by `writeObject()`. A `latency` map of log2(ns) buckets per binding
+ * is included when the histogram mode is on.
+ *
+ * The counters are only compiled in when the addon is built with
+ * `node-gyp rebuild --ref_stats=true`; otherwise this returns `null`.
+ *
+ * ```
+ * var s = ref.stats();
+ * console.log(s.calls.readPointer, s.wrappedPointers.live);
+ * 12 3
+ * ```
+ *
+ * @return {Object} The counters, or `null` when they are compiled out.
+ */
+
+if (!exports.stats) {
+  exports.stats = function stats () {
+    return null
+  }
+}
+
+/**
+ * Zeroes the counters returned by `stats()`, and optionally turns the latency
+ * histogram on or off. The live wrapped pointer gauges are kept.
+ *
+ * @param {Boolean} histogram (optional) Whether to record call latencies.
+ */
+
+if (!exports.resetStats) {
+  exports.resetStats = function resetStats (histogram) {
+  }
+}
+
 /**
  * All these '...' comment blocks below are for the documentation generator.
  *
@@ -1441,6 +2174,22 @@ Buffer.prototype.writeCString = function writeCString (string, offset, encoding)
   return exports.writeCString(this, offset, string, encoding)
 }
 
+/**
+ * ...
+ */
+
+Buffer.prototype.readWString = function readWString (offset, unitSize) {
+  return exports.readWString(this, offset, unitSize)
+}
+
+/**
+ * ...
+ */
+
+Buffer.prototype.writeWString = function writeWString (string, offset, unitSize) {
+  return exports.writeWString(this, offset, string, unitSize)
+}
+
 /**
  * ...
  */
@@ -1573,6 +2322,8 @@ if (!(exports.NULL instanceof Buffer)) {
   SlowBuffer.prototype.writePointer = Buffer.prototype.writePointer
   SlowBuffer.prototype.readCString = Buffer.prototype.readCString
   SlowBuffer.prototype.writeCString = Buffer.prototype.writeCString
+  SlowBuffer.prototype.readWString = Buffer.prototype.readWString
+  SlowBuffer.prototype.writeWString = Buffer.prototype.writeWString
   SlowBuffer.prototype.reinterpret = Buffer.prototype.reinterpret
   SlowBuffer.prototype.reinterpretUntilZeros = Buffer.prototype.reinterpretUntilZeros
   SlowBuffer.prototype.readInt64BE = Buffer.prototype.readInt64BE
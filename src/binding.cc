@@ -2,6 +2,12 @@
 #include <cerrno>
 #include <cstring>
 #include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#ifdef REF_ENABLE_STATS
+  #include <chrono>
+#endif
 
 #include "node.h"
 #include "node_buffer.h"
@@ -15,6 +21,12 @@
   #include <inttypes.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define REF_HAVE_SSE2
+  #include <emmintrin.h>
+#endif
+
 
 using namespace v8;
 using namespace node;
@@ -31,11 +43,291 @@ namespace {
 // we could use `node::Buffer::kMaxLength`, but it's not defined on node v0.6.x
 static const unsigned int kMaxLength = 0x3fffffff;
 
+// upper bound of the `alignedAlloc()` alignment; a 64k page
+static const int64_t kMaxAlignment = 0x10000;
+
 // get int64 from a value
 inline int64_t GetInt64(Local<Value> value) {
+  if (value->IsInt32()) {
+    // the common case; skips the Maybe conversion
+    return value.As<v8::Int32>()->Value();
+  }
   return value->IsNumber() ? Nan::To<int64_t>(value).FromJust() : 0;
 }
 
+/*
+ * Stores the address "offset" bytes into the Buffer in "ptr". The checked
+ * variant of a binding also makes sure that the "size" bytes there lie within
+ * the Buffer and are aligned to "alignment" (a power of 2); otherwise it
+ * throws a RangeError prefixed with "name" and returns false. The unchecked
+ * variant trusts the offset and compiles down to the bare pointer arithmetic.
+ */
+
+template <bool kChecked>
+inline bool GetBufferPointer(const char *name, Local<Value> buf,
+  int64_t offset, size_t size, size_t alignment, char **ptr) {
+  char *data = Buffer::Data(buf.As<Object>());
+  if constexpr (kChecked) {
+    char errmsg[200];
+    size_t length = Buffer::Length(buf.As<Object>());
+    if (offset < 0 || static_cast<uint64_t>(offset) > length ||
+      size > length - static_cast<size_t>(offset)) {
+      snprintf(errmsg, sizeof(errmsg),
+        "%s: offset %" PRId64 " + %" PRIu64 " bytes is out of bounds of a %"
+        PRIu64 " byte Buffer", name, offset, static_cast<uint64_t>(size),
+        static_cast<uint64_t>(length));
+      Nan::ThrowRangeError(errmsg);
+      return false;
+    }
+    // "alignment" is a power of 2, so this stays a mask even if the call
+    // doesn't get inlined with a constant
+    if (data != NULL &&
+      (reinterpret_cast<uintptr_t>(data + offset) & (alignment - 1)) != 0) {
+      snprintf(errmsg, sizeof(errmsg),
+        "%s: offset %" PRId64 " is not aligned to %" PRIu64 " bytes",
+        name, offset, static_cast<uint64_t>(alignment));
+      Nan::ThrowRangeError(errmsg);
+      return false;
+    }
+  }
+  *ptr = data + offset;
+  return true;
+}
+
+/*
+ * Returns how many bytes a binding scanning for a terminator may read at
+ * "offset" into "buf". The checked variant stops at the end of the Buffer,
+ * except for a zero length Buffer: that is a pointer to memory of unknown
+ * size, so like the unchecked variant the scan is unbounded (SIZE_MAX).
+ */
+
+template <bool kChecked>
+inline size_t ScanLimit(Local<Value> buf, int64_t offset) {
+  if constexpr (kChecked) {
+    size_t length = Buffer::Length(buf.As<Object>());
+    if (length > 0) {
+      // GetBufferPointer() has made sure that offset <= length
+      return length - static_cast<size_t>(offset);
+    }
+  }
+  return SIZE_MAX;
+}
+
+/*
+ * Throws the RangeError of a checked scan that found no terminator within
+ * the "limit" bytes left in the Buffer.
+ */
+
+inline void ThrowUnterminated(const char *name, size_t limit) {
+  char errmsg[200];
+  snprintf(errmsg, sizeof(errmsg),
+    "%s: no terminator within the %" PRIu64 " bytes left in the Buffer",
+    name, static_cast<uint64_t>(limit));
+  Nan::ThrowRangeError(errmsg);
+}
+
+/*
+ * The native bindings exported by this module, as (JS name, C++ function).
+ * Together with REF_CHECKED_BINDINGS below, drives both the module exports
+ * and the per-binding `ref.stats()` counters.
+ */
+
+#define REF_BINDINGS(V) \
+  V(writeWString, WriteWString) \
+  V(allocWString, AllocWString) \
+  V(allocCStringArray, AllocCStringArray) \
+  V(copyMemory, CopyMemoryI) \
+  V(addOffset, AddOffset) \
+  V(malloc, Malloc) \
+  V(alignedAlloc, AlignedAlloc) \
+  V(free, Free)
+
+/*
+ * The bindings that access a Buffer at a given offset. Each one is a template
+ * on "kChecked" and gets exported twice: on `checked` with the bounds and
+ * alignment of every access validated against the Buffer length, and on
+ * `unchecked` trusting the offset. The module level export is the unchecked
+ * variant, unless built with `node-gyp rebuild --ref_checked=true`.
+ */
+
+#define REF_CHECKED_BINDINGS(V) \
+  V(address, Address) \
+  V(hexAddress, HexAddress) \
+  V(isNull, IsNull) \
+  V(readObject, ReadObject) \
+  V(writeObject, WriteObject) \
+  V(readPointer, ReadPointer) \
+  V(writePointer, WritePointer) \
+  V(readInt64, ReadInt64) \
+  V(writeInt64, WriteInt64) \
+  V(readUInt64, ReadUInt64) \
+  V(writeUInt64, WriteUInt64) \
+  V(readCString, ReadCString) \
+  V(readWString, ReadWString) \
+  V(reinterpret, ReinterpretBuffer) \
+  V(reinterpretUntilZeros, ReinterpretBufferUntilZeros) \
+  V(reinterpretOwned, ReinterpretOwned) \
+  V(readPointerOwned, ReadPointerOwned) \
+  V(readColumns, ReadColumns) \
+  V(writeColumns, WriteColumns)
+
+#ifdef REF_DEFAULT_CHECKED
+  #define REF_DEFAULT_VARIANT true
+#else
+  #define REF_DEFAULT_VARIANT false
+#endif
+
+#ifdef REF_ENABLE_STATS
+
+enum StatId {
+#define V(name, fn) kStat_##name,
+  REF_CHECKED_BINDINGS(V)
+  REF_BINDINGS(V)
+#undef V
+  kStatCount
+};
+
+static const char *const kStatNames[] = {
+#define V(name, fn) #name,
+  REF_CHECKED_BINDINGS(V)
+  REF_BINDINGS(V)
+#undef V
+};
+
+// log2 buckets of the call latency in nanoseconds; the last one is open ended
+static const int kHistogramBuckets = 32;
+
+/*
+ * Runtime counters. They are thread local so that each Worker (and so each
+ * isolate) sees its own numbers and no atomic operation is needed.
+ */
+
+struct RefStats {
+  uint64_t calls[kStatCount];
+  uint64_t latency[kStatCount][kHistogramBuckets];
+  uint64_t bytesScanned;
+  uint64_t bytesCopied;
+  uint64_t wrappedLive;
+  uint64_t wrappedLiveBytes;
+  uint64_t wrappedTotal;
+  uint64_t globalHandlesCreated;
+  uint64_t globalHandlesCollected;
+  bool histogram;
+};
+
+static thread_local RefStats ref_stats;
+
+/*
+ * Counts a binding invocation, and records its latency when the histogram
+ * mode is on.
+ */
+
+class StatsScope {
+ public:
+  explicit StatsScope(StatId id) : id_(id), timed_(ref_stats.histogram) {
+    ref_stats.calls[id]++;
+    if (timed_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~StatsScope() {
+    if (timed_) {
+      uint64_t ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_).count());
+      int bucket = 0;
+      while (ns > 1 && bucket < kHistogramBuckets - 1) {
+        ns >>= 1;
+        bucket++;
+      }
+      ref_stats.latency[id_][bucket]++;
+    }
+  }
+
+ private:
+  StatId id_;
+  bool timed_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#define REF_STATS_CALL(name) StatsScope stats_scope_(kStat_##name)
+#define REF_STATS_ADD(field, n) (ref_stats.field += (n))
+#define REF_STATS_SUB(field, n) (ref_stats.field -= (n))
+
+#else
+
+#define REF_STATS_CALL(name)
+#define REF_STATS_ADD(field, n)
+#define REF_STATS_SUB(field, n)
+
+#endif // REF_ENABLE_STATS
+
+#if !defined(V8_USE_PERFETTO)
+
+// TRACE_VALUE_TYPE_UINT from V8's trace_event_common.h
+static const uint8_t kTraceValueTypeUInt = 2;
+
+static v8::TracingController *trace_controller = NULL;
+static const uint8_t kTraceDisabled = 0;
+// points into the tracing controller, which flips it when the "ref"
+// category gets enabled or disabled
+static const uint8_t *trace_category = &kTraceDisabled;
+
+/*
+ * Looks up the "ref" trace category once, at module load.
+ */
+
+inline void InitTracing() {
+  trace_controller = GetTracingController();
+  if (trace_controller != NULL) {
+    trace_category = trace_controller->GetCategoryGroupEnabled("ref");
+  }
+}
+
+/*
+ * Emits a complete trace event spanning the lifetime of the scope, when the
+ * "ref" category is enabled with `--trace-event-categories ref` or the
+ * `trace_events` module. Otherwise it costs a load and a branch.
+ */
+
+class TraceScope {
+ public:
+  TraceScope(const char *name, const char *argName, uint64_t argValue)
+    : name_(name), handle_(0) {
+    if (*trace_category) {
+      handle_ = trace_controller->AddTraceEvent('X', trace_category, name,
+        NULL, 0, 0, argName ? 1 : 0, &argName, &kTraceValueTypeUInt,
+        &argValue, NULL, 0);
+    }
+  }
+
+  ~TraceScope() {
+    if (handle_ != 0) {
+      trace_controller->UpdateTraceEventDuration(trace_category, name_,
+        handle_);
+    }
+  }
+
+ private:
+  const char *name_;
+  uint64_t handle_;
+};
+
+#define REF_TRACE_SCOPE(name) TraceScope trace_scope_(name, NULL, 0)
+#define REF_TRACE_SCOPE1(name, argName, argValue) \
+  TraceScope trace_scope_(name, argName, static_cast<uint64_t>(argValue))
+
+#else
+
+inline void InitTracing() {
+}
+
+#define REF_TRACE_SCOPE(name)
+#define REF_TRACE_SCOPE1(name, argName, argValue)
+
+#endif // !V8_USE_PERFETTO
+
 /*
  * Returns the pointer address as a Number of the given Buffer instance.
  * It's recommended to use `hexAddress()` in most cases instead of this function.
@@ -49,7 +341,9 @@ inline int64_t GetInt64(Local<Value> value) {
  * info[2] - Boolean - optional (false) - interpret the content as pointer if true.
  */
 
+template <bool kChecked>
 NAN_METHOD(Address) {
+  REF_STATS_CALL(address);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
@@ -62,12 +356,15 @@ NAN_METHOD(Address) {
   if (info.Length() > 2) {
     external = info[2]->ToBoolean(info.GetIsolate())->IsTrue();
   }
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("address", buf, offset,
+    external ? sizeof(uintptr_t) : 0, external ? alignof(uintptr_t) : 1, &ptr)) {
+    return;
+  }
   if (!external) {
-    char *ptr = Buffer::Data(buf.As<Object>()) + offset;
     intptr = reinterpret_cast<uintptr_t>(ptr);
   } else {
-    uintptr_t *ptrRef = reinterpret_cast<uintptr_t*>(
-      Buffer::Data(buf.As<Object>()) + offset);
+    uintptr_t *ptrRef = reinterpret_cast<uintptr_t*>(ptr);
     intptr = *ptrRef;
   }
   Local<Number> rtn = Nan::New(static_cast<double>(intptr));
@@ -85,7 +382,9 @@ NAN_METHOD(Address) {
  * info[2] - Boolean - optional (false) - interpret the content as pointer if true.
   */
 
+template <bool kChecked>
 NAN_METHOD(HexAddress) {
+  REF_STATS_CALL(hexAddress);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
@@ -98,11 +397,12 @@ NAN_METHOD(HexAddress) {
   if (info.Length() > 2) {
     external = info[2]->ToBoolean(info.GetIsolate())->IsTrue();
   }
-  if (!external) {
-    ptr = Buffer::Data(buf.As<Object>()) + offset;
-  } else {
-    char **ptrRef = reinterpret_cast<char **>(
-      Buffer::Data(buf.As<Object>()) + offset);
+  if (!GetBufferPointer<kChecked>("hexAddress", buf, offset,
+    external ? sizeof(char *) : 0, external ? alignof(char *) : 1, &ptr)) {
+    return;
+  }
+  if (external) {
+    char **ptrRef = reinterpret_cast<char **>(ptr);
     ptr = *ptrRef;
   }
   char strbuf[30]; /* should be plenty... */
@@ -127,7 +427,9 @@ NAN_METHOD(HexAddress) {
  * info[2] - Boolean - optional (false) - interpret the content as pointer if true.
   */
 
+template <bool kChecked>
 NAN_METHOD(IsNull) {
+  REF_STATS_CALL(isNull);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
@@ -135,7 +437,10 @@ NAN_METHOD(IsNull) {
   }
 
   int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("isNull", buf, offset, 0, 1, &ptr)) {
+    return;
+  }
   Local<Value> rtn = Nan::New(ptr == NULL);
 
   info.GetReturnValue().Set(rtn);
@@ -160,12 +465,23 @@ const char *CheckEndianness() {
  */
 
 void wrap_pointer_cb(char *data, void *hint) {
+  REF_STATS_SUB(wrappedLive, 1);
+  REF_STATS_SUB(wrappedLiveBytes, reinterpret_cast<uintptr_t>(hint));
 }
 
 inline Local<Value> WrapPointer(char *ptr, size_t length) {
+  REF_TRACE_SCOPE1("WrapPointer", "length", length);
   Nan::EscapableHandleScope scope;
   if (ptr == NULL) length = 0;
-  return scope.Escape(Nan::NewBuffer(ptr, length, wrap_pointer_cb, NULL).ToLocalChecked());
+  void *hint = NULL;
+#ifdef REF_ENABLE_STATS
+  // the hint carries the length so that the callback can account for it
+  hint = reinterpret_cast<void *>(static_cast<uintptr_t>(length));
+  REF_STATS_ADD(wrappedLive, 1);
+  REF_STATS_ADD(wrappedLiveBytes, length);
+  REF_STATS_ADD(wrappedTotal, 1);
+#endif
+  return scope.Escape(Nan::NewBuffer(ptr, length, wrap_pointer_cb, hint).ToLocalChecked());
 }
 
 /*
@@ -186,7 +502,9 @@ inline Local<Value> WrapNullPointer() {
  * info[1] - Number - the offset from the "buf" buffer's address to read from
  */
 
+template <bool kChecked>
 NAN_METHOD(ReadObject) {
+  REF_STATS_CALL(readObject);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
@@ -194,7 +512,10 @@ NAN_METHOD(ReadObject) {
   }
 
   int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("readObject", buf, offset, sizeof(Persistent<Object>), alignof(Persistent<Object>), &ptr)) {
+    return;
+  }
 
   if (ptr == NULL) {
     return Nan::ThrowError("readObject: Cannot read from NULL pointer");
@@ -211,6 +532,7 @@ NAN_METHOD(ReadObject) {
  */
 
 void write_object_cb(const Nan::WeakCallbackInfo<void>& data) {
+  REF_STATS_ADD(globalHandlesCollected, 1);
   //fprintf(stderr, "write_object_cb\n");
   //NanDisposePersistent(data.GetValue());
 }
@@ -228,7 +550,9 @@ void write_object_cb(const Nan::WeakCallbackInfo<void>& data) {
  *                    A weak reference gets written by default.
  */
 
+template <bool kChecked>
 NAN_METHOD(WriteObject) {
+  REF_STATS_CALL(writeObject);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
@@ -236,7 +560,10 @@ NAN_METHOD(WriteObject) {
   }
 
   int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("writeObject", buf, offset, sizeof(Nan::Persistent<Object>), alignof(Nan::Persistent<Object>), &ptr)) {
+    return;
+  }
 
   Nan::Persistent<Object>* pptr = reinterpret_cast<Nan::Persistent<Object>*>(ptr);
   Local<Object> val = info[2].As<Object>();
@@ -247,6 +574,7 @@ NAN_METHOD(WriteObject) {
 #else
   bool persistent = info[3]->BooleanValue();
 #endif
+  REF_STATS_ADD(globalHandlesCreated, 1);
   if (persistent) {
       (*pptr).Reset(val);
   } else {
@@ -270,7 +598,9 @@ NAN_METHOD(WriteObject) {
  * info[3] - Boolean - the flag whether the pointer is in external or sandbox
  */
 
+template <bool kChecked>
 NAN_METHOD(ReadPointer) {
+  REF_STATS_CALL(readPointer);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
@@ -278,7 +608,10 @@ NAN_METHOD(ReadPointer) {
   }
 
   int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("readPointer", buf, offset, sizeof(char *), alignof(char *), &ptr)) {
+    return;
+  }
   v8::Isolate *isolate = info.GetIsolate();
 #if defined(V8_MAJOR_VERSION) && (V8_MAJOR_VERSION > 4 ||                      \
   (V8_MAJOR_VERSION == 4 && defined(V8_MINOR_VERSION) && V8_MINOR_VERSION > 3))
@@ -318,7 +651,9 @@ NAN_METHOD(ReadPointer) {
  * info[3] - Boolean - the way to convert buf to pointer
  */
 
+template <bool kChecked>
 NAN_METHOD(WritePointer) {
+  REF_STATS_CALL(writePointer);
 
   Local<Value> buf = info[0];
   Local<Value> input = info[2];
@@ -337,8 +672,12 @@ NAN_METHOD(WritePointer) {
     external = info[3]->ToBoolean(info.GetIsolate())->IsTrue();
   }
  
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("writePointer", buf, offset,
+    sizeof(char *), alignof(char *), &ptr)) {
+    return;
+  }
   if (destArray->ByteLength() >= sizeof(void*) + destArray->ByteOffset()) {
-    char *ptr = Buffer::Data(buf.As<Object>()) + offset;
     if (input->IsNull()) {
       *reinterpret_cast<char **>(ptr) = nullptr;
     } else {
@@ -366,28 +705,12 @@ NAN_METHOD(WritePointer) {
 }
 
 /*
- * Reads a machine-endian int64_t from the given Buffer at the given offset.
- *
- * info[0] - Buffer - the "buf" Buffer instance to read from
- * info[1] - Number - the offset from the "buf" buffer's address to read from
+ * Returns the int64_t as a Number, or as a String if a Number would lose
+ * precision.
  */
 
-NAN_METHOD(ReadInt64) {
-
-  Local<Value> buf = info[0];
-  if (!Buffer::HasInstance(buf)) {
-    return Nan::ThrowTypeError("readInt64: Buffer instance expected");
-  }
-
-  int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
-
-  if (ptr == NULL) {
-    return Nan::ThrowTypeError("readInt64: Cannot read from NULL pointer");
-  }
-
-  int64_t val = *reinterpret_cast<int64_t *>(ptr);
-
+inline Local<Value> NewInt64Value(int64_t val) {
+  Nan::EscapableHandleScope scope;
   Local<Value> rtn;
   if (val < JS_MIN_INT || val > JS_MAX_INT) {
     // return a String
@@ -398,30 +721,36 @@ NAN_METHOD(ReadInt64) {
     // return a Number
     rtn = Nan::New<v8::Number>(static_cast<double>(val));
   }
-
-  info.GetReturnValue().Set(rtn);
+  return scope.Escape(rtn);
 }
 
 /*
- * Writes the input Number/String int64 value as a machine-endian int64_t to
- * the given Buffer at the given offset.
- *
- * info[0] - Buffer - the "buf" Buffer instance to write to
- * info[1] - Number - the offset from the "buf" buffer's address to write to
- * info[2] - String/Number - the "input" String or Number which will be written
+ * Returns the uint64_t as a Number, or as a String if a Number would lose
+ * precision.
  */
 
-NAN_METHOD(WriteInt64) {
-
-  Local<Value> buf = info[0];
-  if (!Buffer::HasInstance(buf)) {
-    return Nan::ThrowTypeError("writeInt64: Buffer instance expected");
+inline Local<Value> NewUInt64Value(uint64_t val) {
+  Nan::EscapableHandleScope scope;
+  Local<Value> rtn;
+  if (val > JS_MAX_INT) {
+    // return a String
+    char strbuf[128];
+    snprintf(strbuf, 128, "%" PRIu64, val);
+    rtn = Nan::New<v8::String>(strbuf).ToLocalChecked();
+  } else {
+    // return a Number
+    rtn = Nan::New<v8::Number>(static_cast<double>(val));
   }
+  return scope.Escape(rtn);
+}
 
-  int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+/*
+ * Converts the input Number/String to an int64_t. Throws a TypeError
+ * prefixed with "name" and returns false if it is not a valid int64 value.
+ */
 
-  Local<Value> in = info[2];
+bool ToInt64(const char *name, Local<Value> in, int64_t *out) {
+  char errmsg[200];
   int64_t val;
   if (in->IsNumber()) {
     val = GetInt64(in);
@@ -441,80 +770,34 @@ NAN_METHOD(WriteInt64) {
     val = std::strtoll(str, &endptr, base);
 
     if (endptr == str) {
-      return Nan::ThrowTypeError("writeInt64: no digits we found in input String");
+      snprintf(errmsg, sizeof(errmsg), "%s: no digits we found in input String", name);
+      Nan::ThrowTypeError(errmsg);
+      return false;
     } else  if (errno == ERANGE && (val == LLONG_MAX || val == LLONG_MIN)) {
-      return Nan::ThrowTypeError("writeInt64: input String numerical value out of range");
+      snprintf(errmsg, sizeof(errmsg), "%s: input String numerical value out of range", name);
+      Nan::ThrowTypeError(errmsg);
+      return false;
     } else if (errno != 0 && val == 0) {
-      char errmsg[200];
-      snprintf(errmsg, sizeof(errmsg), "writeInt64: %s", strerror(errno));
-      return Nan::ThrowTypeError(errmsg);
+      snprintf(errmsg, sizeof(errmsg), "%s: %s", name, strerror(errno));
+      Nan::ThrowTypeError(errmsg);
+      return false;
     }
   } else {
-    return Nan::ThrowTypeError("writeInt64: Number/String 64-bit value required");
-  }
-
-  *reinterpret_cast<int64_t *>(ptr) = val;
-
-  info.GetReturnValue().SetUndefined();
-}
-
-/*
- * Reads a machine-endian uint64_t from the given Buffer at the given offset.
- *
- * info[0] - Buffer - the "buf" Buffer instance to read from
- * info[1] - Number - the offset from the "buf" buffer's address to read from
- */
-
-NAN_METHOD(ReadUInt64) {
-
-  Local<Value> buf = info[0];
-  if (!Buffer::HasInstance(buf)) {
-    return Nan::ThrowTypeError("readUInt64: Buffer instance expected");
-  }
-
-  int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
-
-  if (ptr == NULL) {
-    return Nan::ThrowTypeError("readUInt64: Cannot read from NULL pointer");
-  }
-
-  uint64_t val = *reinterpret_cast<uint64_t *>(ptr);
-
-  Local<Value> rtn;
-  if (val > JS_MAX_INT) {
-    // return a String
-    char strbuf[128];
-    snprintf(strbuf, 128, "%" PRIu64, val);
-    rtn = Nan::New<v8::String>(strbuf).ToLocalChecked();
-  } else {
-    // return a Number
-    rtn = Nan::New<v8::Number>(static_cast<double>(val));
+    snprintf(errmsg, sizeof(errmsg), "%s: Number/String 64-bit value required", name);
+    Nan::ThrowTypeError(errmsg);
+    return false;
   }
-
-  info.GetReturnValue().Set(rtn);
+  *out = val;
+  return true;
 }
 
 /*
- * Writes the input Number/String uint64 value as a machine-endian uint64_t to
- * the given Buffer at the given offset.
- *
- * info[0] - Buffer - the "buf" Buffer instance to write to
- * info[1] - Number - the offset from the "buf" buffer's address to write to
- * info[2] - String/Number - the "input" String or Number which will be written
+ * Converts the input Number/String to a uint64_t. Throws a TypeError
+ * prefixed with "name" and returns false if it is not a valid uint64 value.
  */
 
-NAN_METHOD(WriteUInt64) {
-
-  Local<Value> buf = info[0];
-  if (!Buffer::HasInstance(buf)) {
-    return Nan::ThrowTypeError("writeUInt64: Buffer instance expected");
-  }
-
-  int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
-
-  Local<Value> in = info[2];
+bool ToUInt64(const char *name, Local<Value> in, uint64_t *out) {
+  char errmsg[200];
   uint64_t val;
   if (in->IsNumber()) {
     val = GetInt64(in);
@@ -524,7 +807,7 @@ NAN_METHOD(WriteUInt64) {
 
 #if defined(V8_MAJOR_VERSION) && (V8_MAJOR_VERSION > 6 ||                      \
   (V8_MAJOR_VERSION == 6 && defined(V8_MINOR_VERSION) && V8_MINOR_VERSION > 2))
-    String::Utf8Value _str(info.GetIsolate(), in);
+    String::Utf8Value _str(v8::Isolate::GetCurrent(), in);
 #else
     String::Utf8Value _str(in);
 #endif
@@ -534,86 +817,624 @@ NAN_METHOD(WriteUInt64) {
     val = strtoull(str, &endptr, base);
 
     if (endptr == str) {
-      return Nan::ThrowTypeError("writeUInt64: no digits we found in input String");
+      snprintf(errmsg, sizeof(errmsg), "%s: no digits we found in input String", name);
+      Nan::ThrowTypeError(errmsg);
+      return false;
     } else if (errno == ERANGE && val == ULLONG_MAX) {
-      return Nan::ThrowTypeError("writeUInt64: input String numerical value out of range");
+      snprintf(errmsg, sizeof(errmsg), "%s: input String numerical value out of range", name);
+      Nan::ThrowTypeError(errmsg);
+      return false;
     } else if (errno != 0 && val == 0) {
-      char errmsg[200];
-      snprintf(errmsg, sizeof(errmsg), "writeUInt64: %s", strerror(errno));
-      return Nan::ThrowTypeError(errmsg);
+      snprintf(errmsg, sizeof(errmsg), "%s: %s", name, strerror(errno));
+      Nan::ThrowTypeError(errmsg);
+      return false;
     }
   } else {
-    return Nan::ThrowTypeError("writeUInt64: Number/String 64-bit value required");
+    snprintf(errmsg, sizeof(errmsg), "%s: Number/String 64-bit value required", name);
+    Nan::ThrowTypeError(errmsg);
+    return false;
   }
-
-  *reinterpret_cast<uint64_t *>(ptr) = val;
-
-  info.GetReturnValue().SetUndefined();
+  *out = val;
+  return true;
 }
 
 /*
- * Reads a Utf8 C String from the given pointer at the given offset (or 0).
- * I didn't want to add this function but it ends up being necessary for reading
- * past a 0 or 1 length Buffer's boundary in node-ffi :\
+ * Reads a machine-endian int64_t from the given Buffer at the given offset.
  *
  * info[0] - Buffer - the "buf" Buffer instance to read from
  * info[1] - Number - the offset from the "buf" buffer's address to read from
  */
 
-NAN_METHOD(ReadCString) {
+template <bool kChecked>
+NAN_METHOD(ReadInt64) {
+  REF_STATS_CALL(readInt64);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
-    return Nan::ThrowTypeError("readCString: Buffer instance expected");
+    return Nan::ThrowTypeError("readInt64: Buffer instance expected");
   }
 
   int64_t offset = GetInt64(info[1]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("readInt64", buf, offset, sizeof(int64_t), alignof(int64_t), &ptr)) {
+    return;
+  }
 
   if (ptr == NULL) {
-    return Nan::ThrowError("readCString: Cannot read from NULL pointer");
+    return Nan::ThrowTypeError("readInt64: Cannot read from NULL pointer");
   }
 
-  Local<Value> rtn = Nan::New<v8::String>(ptr).ToLocalChecked();
-  info.GetReturnValue().Set(rtn);
+  int64_t val = *reinterpret_cast<int64_t *>(ptr);
+
+  info.GetReturnValue().Set(NewInt64Value(val));
 }
 
 /*
- * Returns a new Buffer instance that has the same memory address
- * as the given buffer, but with the specified size.
+ * Writes the input Number/String int64 value as a machine-endian int64_t to
+ * the given Buffer at the given offset.
  *
- * info[0] - Buffer - the "buf" Buffer instance to read the address from
- * info[1] - Number - the size in bytes that the returned Buffer should be
- * info[2] - Number - the offset from the "buf" buffer's address to read from
+ * info[0] - Buffer - the "buf" Buffer instance to write to
+ * info[1] - Number - the offset from the "buf" buffer's address to write to
+ * info[2] - String/Number - the "input" String or Number which will be written
  */
 
-NAN_METHOD(ReinterpretBuffer) {
+template <bool kChecked>
+NAN_METHOD(WriteInt64) {
+  REF_STATS_CALL(writeInt64);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
-    return Nan::ThrowTypeError("reinterpret: Buffer instance expected");
+    return Nan::ThrowTypeError("writeInt64: Buffer instance expected");
   }
 
-  int64_t offset = GetInt64(info[2]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  int64_t offset = GetInt64(info[1]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("writeInt64", buf, offset, sizeof(int64_t), alignof(int64_t), &ptr)) {
+    return;
+  }
 
-  if (ptr == NULL) {
-    return Nan::ThrowError("reinterpret: Cannot reinterpret from NULL pointer");
+  int64_t val;
+  if (!ToInt64("writeInt64", info[2], &val)) {
+    return;
   }
 
-#if defined(V8_MAJOR_VERSION) && (V8_MAJOR_VERSION > 4 ||                      \
-  (V8_MAJOR_VERSION == 4 && defined(V8_MINOR_VERSION) && V8_MINOR_VERSION > 3))
-  v8::Isolate *isolate = info.GetIsolate();
-  size_t size = info[1]->Uint32Value(isolate->GetCurrentContext()).FromJust();
-#else
-  size_t size = info[1]->Uint32Value();
-#endif
+  *reinterpret_cast<int64_t *>(ptr) = val;
 
-  info.GetReturnValue().Set(WrapPointer(ptr, size));
+  info.GetReturnValue().SetUndefined();
 }
 
 /*
- * Returns a new Buffer instance that has the same memory address
+ * Reads a machine-endian uint64_t from the given Buffer at the given offset.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to read from
+ * info[1] - Number - the offset from the "buf" buffer's address to read from
+ */
+
+template <bool kChecked>
+NAN_METHOD(ReadUInt64) {
+  REF_STATS_CALL(readUInt64);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("readUInt64: Buffer instance expected");
+  }
+
+  int64_t offset = GetInt64(info[1]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("readUInt64", buf, offset, sizeof(uint64_t), alignof(uint64_t), &ptr)) {
+    return;
+  }
+
+  if (ptr == NULL) {
+    return Nan::ThrowTypeError("readUInt64: Cannot read from NULL pointer");
+  }
+
+  uint64_t val = *reinterpret_cast<uint64_t *>(ptr);
+
+  info.GetReturnValue().Set(NewUInt64Value(val));
+}
+
+/*
+ * Writes the input Number/String uint64 value as a machine-endian uint64_t to
+ * the given Buffer at the given offset.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to write to
+ * info[1] - Number - the offset from the "buf" buffer's address to write to
+ * info[2] - String/Number - the "input" String or Number which will be written
+ */
+
+template <bool kChecked>
+NAN_METHOD(WriteUInt64) {
+  REF_STATS_CALL(writeUInt64);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("writeUInt64: Buffer instance expected");
+  }
+
+  int64_t offset = GetInt64(info[1]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("writeUInt64", buf, offset, sizeof(uint64_t), alignof(uint64_t), &ptr)) {
+    return;
+  }
+
+  uint64_t val;
+  if (!ToUInt64("writeUInt64", info[2], &val)) {
+    return;
+  }
+
+  *reinterpret_cast<uint64_t *>(ptr) = val;
+
+  info.GetReturnValue().SetUndefined();
+}
+
+/*
+ * Reads a Utf8 C String from the given pointer at the given offset (or 0).
+ * I didn't want to add this function but it ends up being necessary for reading
+ * past a 0 or 1 length Buffer's boundary in node-ffi :\
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to read from
+ * info[1] - Number - the offset from the "buf" buffer's address to read from
+ */
+
+template <bool kChecked>
+NAN_METHOD(ReadCString) {
+  REF_STATS_CALL(readCString);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("readCString: Buffer instance expected");
+  }
+
+  int64_t offset = GetInt64(info[1]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("readCString", buf, offset, 0, 1, &ptr)) {
+    return;
+  }
+
+  if (ptr == NULL) {
+    return Nan::ThrowError("readCString: Cannot read from NULL pointer");
+  }
+
+  size_t limit = ScanLimit<kChecked>(buf, offset);
+  if (limit == SIZE_MAX) {
+    info.GetReturnValue().Set(Nan::New<v8::String>(ptr).ToLocalChecked());
+    return;
+  }
+  const char *end = static_cast<const char *>(std::memchr(ptr, 0, limit));
+  if (end == NULL) {
+    return ThrowUnterminated("readCString", limit);
+  }
+  info.GetReturnValue().Set(Nan::New<v8::String>(ptr,
+    static_cast<int>(end - ptr)).ToLocalChecked());
+}
+
+/*
+ * Returns the number of "Unit" sized code units before the first 0 unit
+ * among the "limit" bytes at "ptr", or SIZE_MAX if there is none.
+ */
+
+template <typename Unit>
+size_t FindTerminatorWithin(const char *ptr, size_t limit) {
+  Unit unit;
+  for (size_t len = 0; len < limit / sizeof(Unit); len++) {
+    std::memcpy(&unit, ptr + len * sizeof(Unit), sizeof(Unit));
+    if (unit == 0) return len;
+  }
+  return SIZE_MAX;
+}
+
+/*
+ * Returns the number of "Unit" sized code units before the first 0 unit at
+ * "ptr". When "ptr" is aligned to the unit size, the scan compares 16 bytes
+ * at a time using aligned SSE2 loads, which never cross a page boundary.
+ */
+
+template <typename Unit>
+size_t FindTerminator(const char *ptr) {
+  size_t len = 0;
+  if (reinterpret_cast<uintptr_t>(ptr) % sizeof(Unit) != 0) {
+    Unit unit;
+    for (;; len++) {
+      std::memcpy(&unit, ptr + len * sizeof(Unit), sizeof(Unit));
+      if (unit == 0) return len;
+    }
+  }
+
+  const Unit *p = reinterpret_cast<const Unit *>(ptr);
+#ifdef REF_HAVE_SSE2
+  while (reinterpret_cast<uintptr_t>(p + len) % 16 != 0) {
+    if (p[len] == 0) return len;
+    len++;
+  }
+  const __m128i zero = _mm_setzero_si128();
+  for (;; len += 16 / sizeof(Unit)) {
+    __m128i chunk = _mm_load_si128(reinterpret_cast<const __m128i *>(p + len));
+    __m128i eq;
+    if constexpr (sizeof(Unit) == 2) {
+      eq = _mm_cmpeq_epi16(chunk, zero);
+    } else {
+      eq = _mm_cmpeq_epi32(chunk, zero);
+    }
+    if (_mm_movemask_epi8(eq) != 0) break;
+  }
+#endif
+  while (p[len] != 0) len++;
+  return len;
+}
+
+/*
+ * Returns the wide character unit size (2 for UTF-16, 4 for UTF-32) from the
+ * given optional argument, defaulting to `sizeof(wchar_t)`. Returns 0 for an
+ * unsupported size.
+ */
+
+inline size_t GetWCharSize(Local<Value> value) {
+  if (value->IsUndefined() || value->IsNull()) {
+    return sizeof(wchar_t);
+  }
+  int64_t size = GetInt64(value);
+  return size == 2 || size == 4 ? static_cast<size_t>(size) : 0;
+}
+
+/*
+ * Creates a JS String from "len" UTF-32 code units. Invalid code points
+ * become U+FFFD.
+ */
+
+inline MaybeLocal<String> NewStringFromUtf32(v8::Isolate *isolate,
+  const char *ptr, size_t len) {
+  std::vector<uint16_t> utf16;
+  utf16.reserve(len);
+  for (size_t i = 0; i < len; i++) {
+    uint32_t cp;
+    std::memcpy(&cp, ptr + i * 4, 4);
+    if (cp >= 0x10000 && cp <= 0x10FFFF) {
+      cp -= 0x10000;
+      utf16.push_back(static_cast<uint16_t>(0xD800 + (cp >> 10)));
+      utf16.push_back(static_cast<uint16_t>(0xDC00 + (cp & 0x3FF)));
+    } else if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+      utf16.push_back(0xFFFD);
+    } else {
+      utf16.push_back(static_cast<uint16_t>(cp));
+    }
+  }
+  return String::NewFromTwoByte(isolate, utf16.data(),
+    NewStringType::kNormal, static_cast<int>(utf16.size()));
+}
+
+/*
+ * Reads a NUL terminated wide character String from the given pointer at the
+ * given offset (or 0). The JS String is created straight from the native
+ * memory, without an in-between Buffer.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to read from
+ * info[1] - Number - the offset from the "buf" buffer's address to read from
+ * info[2] - Number - optional (sizeof(wchar_t)) - the unit size, 2 or 4
+ */
+
+template <bool kChecked>
+NAN_METHOD(ReadWString) {
+  REF_STATS_CALL(readWString);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("readWString: Buffer instance expected");
+  }
+  size_t unit = GetWCharSize(info[2]);
+  if (unit == 0) {
+    return Nan::ThrowRangeError("readWString: unit size must be 2 or 4");
+  }
+
+  int64_t offset = GetInt64(info[1]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("readWString", buf, offset, 0, 1, &ptr)) {
+    return;
+  }
+
+  if (ptr == NULL) {
+    return Nan::ThrowError("readWString: Cannot read from NULL pointer");
+  }
+
+  v8::Isolate *isolate = info.GetIsolate();
+  MaybeLocal<String> rtn;
+  REF_TRACE_SCOPE1("readWString", "unit", unit);
+  size_t limit = ScanLimit<kChecked>(buf, offset);
+  if (unit == 2) {
+    size_t len = limit == SIZE_MAX ? FindTerminator<uint16_t>(ptr)
+      : FindTerminatorWithin<uint16_t>(ptr, limit);
+    if (len == SIZE_MAX) {
+      return ThrowUnterminated("readWString", limit);
+    }
+    REF_STATS_ADD(bytesScanned, (len + 1) * 2);
+    if (len > static_cast<size_t>(String::kMaxLength)) {
+      return Nan::ThrowRangeError("readWString: String is too long");
+    }
+    if (reinterpret_cast<uintptr_t>(ptr) % alignof(uint16_t) == 0) {
+      rtn = String::NewFromTwoByte(isolate,
+        reinterpret_cast<const uint16_t *>(ptr),
+        NewStringType::kNormal, static_cast<int>(len));
+    } else {
+      std::vector<uint16_t> units(len);
+      std::memcpy(units.data(), ptr, len * 2);
+      rtn = String::NewFromTwoByte(isolate, units.data(),
+        NewStringType::kNormal, static_cast<int>(len));
+    }
+  } else {
+    size_t len = limit == SIZE_MAX ? FindTerminator<uint32_t>(ptr)
+      : FindTerminatorWithin<uint32_t>(ptr, limit);
+    if (len == SIZE_MAX) {
+      return ThrowUnterminated("readWString", limit);
+    }
+    REF_STATS_ADD(bytesScanned, (len + 1) * 4);
+    if (len > static_cast<size_t>(String::kMaxLength)) {
+      return Nan::ThrowRangeError("readWString: String is too long");
+    }
+    rtn = NewStringFromUtf32(isolate, ptr, len);
+  }
+
+  if (rtn.IsEmpty()) {
+    return Nan::ThrowRangeError("readWString: String is too long");
+  }
+  info.GetReturnValue().Set(rtn.ToLocalChecked());
+}
+
+/*
+ * Returns the number of bytes, NUL terminator included, the given String
+ * takes as wide characters of the given unit size.
+ */
+
+inline size_t WStringByteLength(v8::Isolate *isolate, Local<String> str,
+  size_t unit, std::vector<uint16_t> &utf16) {
+  int len = str->Length();
+  if (unit == 2) {
+    return (static_cast<size_t>(len) + 1) * 2;
+  }
+  utf16.resize(len);
+  str->Write(isolate, utf16.data(), 0, len, String::NO_NULL_TERMINATION);
+  size_t count = 0;
+  for (int i = 0; i < len; i++, count++) {
+    if (utf16[i] >= 0xD800 && utf16[i] <= 0xDBFF && i + 1 < len &&
+      utf16[i + 1] >= 0xDC00 && utf16[i + 1] <= 0xDFFF) {
+      i++;
+    }
+  }
+  return (count + 1) * 4;
+}
+
+/*
+ * Writes the given String as NUL terminated wide characters to "ptr", which
+ * must have room for `WStringByteLength()` bytes. For a unit size of 4, "utf16"
+ * holds the String contents from `WStringByteLength()`.
+ */
+
+inline void WriteWStringTo(v8::Isolate *isolate, char *ptr, Local<String> str,
+  size_t unit, const std::vector<uint16_t> &utf16) {
+  int len = str->Length();
+  if (unit == 2) {
+    if (reinterpret_cast<uintptr_t>(ptr) % alignof(uint16_t) == 0) {
+      str->Write(isolate, reinterpret_cast<uint16_t *>(ptr), 0, len,
+        String::NO_NULL_TERMINATION);
+    } else {
+      std::vector<uint16_t> units(len);
+      str->Write(isolate, units.data(), 0, len, String::NO_NULL_TERMINATION);
+      std::memcpy(ptr, units.data(), len * 2);
+    }
+    std::memset(ptr + len * 2, 0, 2);
+    return;
+  }
+
+  for (int i = 0; i < len; i++) {
+    uint32_t cp = utf16[i];
+    if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < len &&
+      utf16[i + 1] >= 0xDC00 && utf16[i + 1] <= 0xDFFF) {
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (utf16[i + 1] - 0xDC00);
+      i++;
+    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+      cp = 0xFFFD;
+    }
+    std::memcpy(ptr, &cp, 4);
+    ptr += 4;
+  }
+  std::memset(ptr, 0, 4);
+}
+
+/*
+ * Writes the given String as NUL terminated wide characters to the given
+ * Buffer at the given offset. The Buffer must actually have the proper length.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to write to
+ * info[1] - Number - the offset from the "buf" buffer's address to write to
+ * info[2] - String - the "input" String which will be written
+ * info[3] - Number - optional (sizeof(wchar_t)) - the unit size, 2 or 4
+ */
+
+NAN_METHOD(WriteWString) {
+  REF_STATS_CALL(writeWString);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("writeWString: Buffer instance expected");
+  }
+  if (!info[2]->IsString()) {
+    return Nan::ThrowTypeError("writeWString: String expected as third argument");
+  }
+  size_t unit = GetWCharSize(info[3]);
+  if (unit == 0) {
+    return Nan::ThrowRangeError("writeWString: unit size must be 2 or 4");
+  }
+
+  v8::Isolate *isolate = info.GetIsolate();
+  Local<String> str = info[2].As<String>();
+  int64_t offset = GetInt64(info[1]);
+  size_t length = Buffer::Length(buf.As<Object>());
+  std::vector<uint16_t> utf16;
+  size_t size = WStringByteLength(isolate, str, unit, utf16);
+  if (offset < 0 || static_cast<size_t>(offset) > length ||
+    size > length - static_cast<size_t>(offset)) {
+    return Nan::ThrowRangeError("writeWString: String does not fit in the Buffer");
+  }
+
+  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  WriteWStringTo(isolate, ptr, str, unit, utf16);
+
+  info.GetReturnValue().SetUndefined();
+}
+
+/*
+ * Returns a new Buffer instance with the given String written to it as NUL
+ * terminated wide characters.
+ *
+ * info[0] - String - the "input" String which will be written
+ * info[1] - Number - optional (sizeof(wchar_t)) - the unit size, 2 or 4
+ */
+
+NAN_METHOD(AllocWString) {
+  REF_STATS_CALL(allocWString);
+
+  if (!info[0]->IsString()) {
+    return Nan::ThrowTypeError("allocWString: String expected");
+  }
+  size_t unit = GetWCharSize(info[1]);
+  if (unit == 0) {
+    return Nan::ThrowRangeError("allocWString: unit size must be 2 or 4");
+  }
+
+  v8::Isolate *isolate = info.GetIsolate();
+  Local<String> str = info[0].As<String>();
+  std::vector<uint16_t> utf16;
+  size_t size = WStringByteLength(isolate, str, unit, utf16);
+  if (size > kMaxLength) {
+    return Nan::ThrowRangeError("allocWString: String is too long");
+  }
+
+  Local<Object> rtn =
+    Nan::NewBuffer(static_cast<uint32_t>(size)).ToLocalChecked();
+  WriteWStringTo(isolate, Buffer::Data(rtn), str, unit, utf16);
+
+  info.GetReturnValue().Set(rtn);
+}
+
+/*
+ * Returns a new Buffer instance holding a `char *` table followed by every
+ * String of the given Array as a NUL terminated C String, with each table
+ * entry pointing at its String. Everything lives in one allocation, so the
+ * Buffer is all that has to be kept alive. `null` and `undefined` entries
+ * become NULL pointers.
+ *
+ * info[0] - Array - the Strings to write
+ * info[1] - String - optional ('utf8') - the encoding of the C Strings
+ * info[2] - Boolean - optional (true) - append a NULL pointer to the table
+ */
+
+NAN_METHOD(AllocCStringArray) {
+  REF_STATS_CALL(allocCStringArray);
+
+  if (!info[0]->IsArray()) {
+    return Nan::ThrowTypeError("allocCStringArray: Array expected");
+  }
+  v8::Isolate *isolate = info.GetIsolate();
+  Local<v8::Array> array = info[0].As<v8::Array>();
+  enum encoding enc = ParseEncoding(isolate, info[1], UTF8);
+  bool terminate = info[2]->IsUndefined() ||
+    info[2]->ToBoolean(isolate)->IsTrue();
+
+  uint32_t count = array->Length();
+  size_t total = (static_cast<size_t>(count) + (terminate ? 1 : 0)) *
+    sizeof(char *);
+  if (total > kMaxLength) {
+    return Nan::ThrowRangeError("allocCStringArray: Array is too long");
+  }
+  std::vector<Local<Value> > strings(count);
+  std::vector<size_t> sizes(count);
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> val;
+    if (!Nan::Get(array, i).ToLocal(&val)) {
+      return;
+    }
+    if (val->IsNullOrUndefined()) {
+      continue;
+    }
+    if (!val->IsString()) {
+      return Nan::ThrowTypeError(
+        "allocCStringArray: Array of Strings expected");
+    }
+    ssize_t size = DecodeBytes(isolate, val, enc);
+    if (size < 0) {
+      return Nan::ThrowError("allocCStringArray: cannot encode String");
+    }
+    strings[i] = val;
+    sizes[i] = static_cast<size_t>(size);
+    total += sizes[i] + 1;
+    if (total > kMaxLength) {
+      return Nan::ThrowRangeError("allocCStringArray: Strings are too long");
+    }
+  }
+
+  Local<Object> rtn =
+    Nan::NewBuffer(static_cast<uint32_t>(total)).ToLocalChecked();
+  char *data = Buffer::Data(rtn);
+  char **table = reinterpret_cast<char **>(data);
+  char *ptr = data + (static_cast<size_t>(count) + (terminate ? 1 : 0)) *
+    sizeof(char *);
+  for (uint32_t i = 0; i < count; i++) {
+    if (strings[i].IsEmpty()) {
+      table[i] = NULL;
+      continue;
+    }
+    table[i] = ptr;
+    DecodeWrite(isolate, ptr, sizes[i], strings[i], enc);
+    ptr[sizes[i]] = 0;
+    ptr += sizes[i] + 1;
+  }
+  if (terminate) {
+    table[count] = NULL;
+  }
+
+  info.GetReturnValue().Set(rtn);
+}
+
+/*
+ * Returns a new Buffer instance that has the same memory address
+ * as the given buffer, but with the specified size.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to read the address from
+ * info[1] - Number - the size in bytes that the returned Buffer should be
+ * info[2] - Number - the offset from the "buf" buffer's address to read from
+ */
+
+template <bool kChecked>
+NAN_METHOD(ReinterpretBuffer) {
+  REF_STATS_CALL(reinterpret);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("reinterpret: Buffer instance expected");
+  }
+
+  int64_t offset = GetInt64(info[2]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("reinterpret", buf, offset, 0, 1, &ptr)) {
+    return;
+  }
+
+  if (ptr == NULL) {
+    return Nan::ThrowError("reinterpret: Cannot reinterpret from NULL pointer");
+  }
+
+#if defined(V8_MAJOR_VERSION) && (V8_MAJOR_VERSION > 4 ||                      \
+  (V8_MAJOR_VERSION == 4 && defined(V8_MINOR_VERSION) && V8_MINOR_VERSION > 3))
+  v8::Isolate *isolate = info.GetIsolate();
+  size_t size = info[1]->Uint32Value(isolate->GetCurrentContext()).FromJust();
+#else
+  size_t size = info[1]->Uint32Value();
+#endif
+
+  info.GetReturnValue().Set(WrapPointer(ptr, size));
+}
+
+/*
+ * Returns a new Buffer instance that has the same memory address
  * as the given buffer, but with a length up to the first aligned set of values of
  * 0 in a row for the given length.
  *
@@ -622,7 +1443,9 @@ NAN_METHOD(ReinterpretBuffer) {
  * info[2] - Number - the offset from the "buf" buffer's address to read from
  */
 
+template <bool kChecked>
 NAN_METHOD(ReinterpretBufferUntilZeros) {
+  REF_STATS_CALL(reinterpretUntilZeros);
 
   Local<Value> buf = info[0];
   if (!Buffer::HasInstance(buf)) {
@@ -630,7 +1453,10 @@ NAN_METHOD(ReinterpretBufferUntilZeros) {
   }
 
   int64_t offset = GetInt64(info[2]);
-  char *ptr = Buffer::Data(buf.As<Object>()) + offset;
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("reinterpretUntilZeros", buf, offset, 0, 1, &ptr)) {
+    return;
+  }
 
   if (ptr == NULL) {
     return Nan::ThrowError("reinterpretUntilZeros: Cannot reinterpret from NULL pointer");
@@ -648,20 +1474,250 @@ NAN_METHOD(ReinterpretBufferUntilZeros) {
   size_t size = 0;
   bool end = false;
 
-  while (!end && size < kMaxLength) {
-    end = true;
-    for (i = 0; i < numZeros; i++) {
-      if (ptr[size + i] != 0) {
-        end = false;
-        break;
-      }
-    }
-    if (!end) {
-      size += numZeros;
+  size_t limit = ScanLimit<kChecked>(buf, offset);
+
+  REF_TRACE_SCOPE1("reinterpretUntilZeros", "numZeros", numZeros);
+  while (!end && size < kMaxLength) {
+    if (numZeros > limit - size) {
+      // the next group of zeros would lie past the end of the Buffer
+      return ThrowUnterminated("reinterpretUntilZeros", limit);
+    }
+    end = true;
+    for (i = 0; i < numZeros; i++) {
+      if (ptr[size + i] != 0) {
+        end = false;
+        break;
+      }
+    }
+    if (!end) {
+      size += numZeros;
+    }
+  }
+  REF_STATS_ADD(bytesScanned, size + numZeros);
+
+  info.GetReturnValue().Set(WrapPointer(ptr, size));
+}
+
+/*
+ * A field of a struct array bound to the typed array holding its column.
+ */
+
+struct Column {
+  size_t offset;
+  size_t size;
+  char *data;
+};
+
+/*
+ * Reads the [field offset, typed array] pairs of info[4] into "columns",
+ * checking that each typed array can hold "count" elements and that each
+ * field lies within a struct of "stride" bytes. Throws and returns false
+ * otherwise.
+ */
+
+bool GetColumns(const Nan::FunctionCallbackInfo<v8::Value>& info,
+  const char *name, size_t count, size_t stride,
+  std::vector<Column> &columns) {
+  char errmsg[200];
+  if (!info[4]->IsArray()) {
+    snprintf(errmsg, sizeof(errmsg), "%s: Array of fields expected", name);
+    Nan::ThrowTypeError(errmsg);
+    return false;
+  }
+  Local<v8::Array> fields = info[4].As<v8::Array>();
+  uint32_t length = fields->Length();
+  columns.resize(length);
+  for (uint32_t i = 0; i < length; i++) {
+    Local<Value> field;
+    Local<Value> offset;
+    Local<Value> column;
+    if (!Nan::Get(fields, i).ToLocal(&field) || !field->IsArray() ||
+      !Nan::Get(field.As<Object>(), 0).ToLocal(&offset) ||
+      !Nan::Get(field.As<Object>(), 1).ToLocal(&column) ||
+      !column->IsTypedArray()) {
+      snprintf(errmsg, sizeof(errmsg),
+        "%s: [offset, TypedArray] field expected", name);
+      Nan::ThrowTypeError(errmsg);
+      return false;
+    }
+    Local<v8::TypedArray> array = column.As<v8::TypedArray>();
+    size_t elements = array->Length();
+    size_t size = elements ? array->ByteLength() / elements : 0;
+    if (elements < count) {
+      snprintf(errmsg, sizeof(errmsg),
+        "%s: column %u is shorter than the row count", name, i);
+      Nan::ThrowRangeError(errmsg);
+      return false;
+    }
+    int64_t fieldOffset = GetInt64(offset);
+    if (fieldOffset < 0 || static_cast<uint64_t>(fieldOffset) > stride ||
+      size > stride - static_cast<size_t>(fieldOffset)) {
+      snprintf(errmsg, sizeof(errmsg),
+        "%s: field %u at offset %" PRId64 " does not fit in a %" PRIu64
+        " byte struct", name, i, fieldOffset, static_cast<uint64_t>(stride));
+      Nan::ThrowRangeError(errmsg);
+      return false;
+    }
+    columns[i].offset = static_cast<size_t>(fieldOffset);
+    columns[i].size = size;
+    columns[i].data = static_cast<char *>(array->Buffer()->Data()) +
+      array->ByteOffset();
+  }
+  return true;
+}
+
+/*
+ * Resolves the address of the first of "count" structs, "stride" bytes
+ * apart, at "offset" into "buf". The checked variant also makes sure that
+ * every field of every struct lies within the Buffer; otherwise it throws a
+ * RangeError prefixed with "name" and returns false.
+ */
+
+template <bool kChecked>
+inline bool GetColumnsPointer(const char *name, Local<Value> buf,
+  int64_t offset, int64_t count, int64_t stride,
+  const std::vector<Column> &columns, char **ptr) {
+  size_t span = 0;
+  if constexpr (kChecked) {
+    if (count > 0) {
+      size_t end = 0;
+      for (const Column &column : columns) {
+        if (column.offset + column.size > end) {
+          end = column.offset + column.size;
+        }
+      }
+      uint64_t rows = static_cast<uint64_t>(count - 1);
+      if (stride != 0 &&
+        rows > (SIZE_MAX - end) / static_cast<uint64_t>(stride)) {
+        char errmsg[200];
+        snprintf(errmsg, sizeof(errmsg),
+          "%s: %" PRId64 " structs of %" PRId64 " bytes overflow", name,
+          count, stride);
+        Nan::ThrowRangeError(errmsg);
+        return false;
+      }
+      span = static_cast<size_t>(rows * static_cast<uint64_t>(stride)) + end;
+    }
+  }
+  return GetBufferPointer<kChecked>(name, buf, offset, span, 1, ptr);
+}
+
+/*
+ * Copies one element of "size" bytes; the fixed sizes let the compiler turn
+ * the memcpy() into a single (unaligned) load and store.
+ */
+
+inline void CopyElement(char *dst, const char *src, size_t size) {
+  switch (size) {
+    case 1: *dst = *src; break;
+    case 2: std::memcpy(dst, src, 2); break;
+    case 4: std::memcpy(dst, src, 4); break;
+    case 8: std::memcpy(dst, src, 8); break;
+    default: std::memcpy(dst, src, size); break;
+  }
+}
+
+/*
+ * Decodes an array of "count" structs, "stride" bytes apart, into one typed
+ * array per field, in a single pass over the structs. The typed arrays must
+ * have the element size of their field.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to read from
+ * info[1] - Number - the offset from the "buf" buffer's address to read from
+ * info[2] - Number - the number of structs
+ * info[3] - Number - the size in bytes of each struct
+ * info[4] - Array - [field offset, TypedArray] pairs
+ */
+
+template <bool kChecked>
+NAN_METHOD(ReadColumns) {
+  REF_STATS_CALL(readColumns);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("readColumns: Buffer instance expected");
+  }
+
+  int64_t offset = GetInt64(info[1]);
+  int64_t count = GetInt64(info[2]);
+  int64_t stride = GetInt64(info[3]);
+  if (offset < 0 || count < 0 || stride < 0) {
+    return Nan::ThrowRangeError("readColumns: invalid offset, count or stride");
+  }
+  std::vector<Column> columns;
+  if (!GetColumns(info, "readColumns", static_cast<size_t>(count),
+    static_cast<size_t>(stride), columns)) {
+    return;
+  }
+
+  char *ptr;
+  if (!GetColumnsPointer<kChecked>("readColumns", buf, offset, count, stride,
+    columns, &ptr)) {
+    return;
+  }
+  if (ptr == NULL && count > 0) {
+    return Nan::ThrowError("readColumns: Cannot read from NULL pointer");
+  }
+
+  for (int64_t i = 0; i < count; i++, ptr += stride) {
+    for (Column &column : columns) {
+      CopyElement(column.data + i * column.size, ptr + column.offset,
+        column.size);
+    }
+  }
+
+  info.GetReturnValue().SetUndefined();
+}
+
+/*
+ * Encodes one typed array per field back into an array of "count" structs,
+ * "stride" bytes apart, in a single pass over the structs.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to write to
+ * info[1] - Number - the offset from the "buf" buffer's address to write to
+ * info[2] - Number - the number of structs
+ * info[3] - Number - the size in bytes of each struct
+ * info[4] - Array - [field offset, TypedArray] pairs
+ */
+
+template <bool kChecked>
+NAN_METHOD(WriteColumns) {
+  REF_STATS_CALL(writeColumns);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("writeColumns: Buffer instance expected");
+  }
+
+  int64_t offset = GetInt64(info[1]);
+  int64_t count = GetInt64(info[2]);
+  int64_t stride = GetInt64(info[3]);
+  if (offset < 0 || count < 0 || stride < 0) {
+    return Nan::ThrowRangeError("writeColumns: invalid offset, count or stride");
+  }
+  std::vector<Column> columns;
+  if (!GetColumns(info, "writeColumns", static_cast<size_t>(count),
+    static_cast<size_t>(stride), columns)) {
+    return;
+  }
+
+  char *ptr;
+  if (!GetColumnsPointer<kChecked>("writeColumns", buf, offset, count, stride,
+    columns, &ptr)) {
+    return;
+  }
+  if (ptr == NULL && count > 0) {
+    return Nan::ThrowError("writeColumns: Cannot write to NULL pointer");
+  }
+
+  for (int64_t i = 0; i < count; i++, ptr += stride) {
+    for (Column &column : columns) {
+      CopyElement(ptr + column.offset, column.data + i * column.size,
+        column.size);
     }
   }
 
-  info.GetReturnValue().Set(WrapPointer(ptr, size));
+  info.GetReturnValue().SetUndefined();
 }
 
 /**
@@ -671,6 +1727,7 @@ NAN_METHOD(ReinterpretBufferUntilZeros) {
  * info[2] - Number - the "size" value which indicate copy size 
  */
 NAN_METHOD(CopyMemoryI) {
+    REF_STATS_CALL(copyMemory);
     Nan::HandleScope scope;
     int state;
     state = info.Length() > 2 ? 0 : -1;
@@ -689,6 +1746,13 @@ NAN_METHOD(CopyMemoryI) {
             Nan::ThrowError("expect 2nd argument Array buffer view");
         }
     }
+    if (state == 0) {
+        state = node::Buffer::Length(info[0]) >= sizeof(void*)
+            && node::Buffer::Length(info[1]) >= sizeof(void*) ? 0 : -1;
+        if (state) {
+            Nan::ThrowRangeError("expect arguments holding a pointer");
+        }
+    }
     v8::Isolate* isolate;
     isolate = info.GetIsolate();
     v8::Local<Context> ctx = isolate->GetCurrentContext();
@@ -706,7 +1770,9 @@ NAN_METHOD(CopyMemoryI) {
                 node::Buffer::Data(dst)); 
             void** srcPtrRef = reinterpret_cast<void**>(
                 node::Buffer::Data(src));
+            REF_TRACE_SCOPE1("copyMemory", "size", size);
             std::memcpy(*dstPtrRef, *srcPtrRef, size);
+            REF_STATS_ADD(bytesCopied, size);
         } 
     }
 }
@@ -714,9 +1780,10 @@ NAN_METHOD(CopyMemoryI) {
 /**
  * add displacement to external pointer
  * info[0] - Buffer - the "pointer" buffer instance.
- * info[1] - Number - the offset value to be added 
+ * info[1] - Number - the 64-bit offset value to be added 
  */
 NAN_METHOD(AddOffset) {
+    REF_STATS_CALL(addOffset);
     Nan::HandleScope scope;
     int state;
     state = info.Length() > 1 ? 0 : -1;
@@ -729,13 +1796,19 @@ NAN_METHOD(AddOffset) {
             Nan::ThrowError("expect 1st argument Array buffer view");
         }
     }
+    if (state == 0) {
+        state = node::Buffer::Length(info[0]) >= sizeof(void*) ? 0 : -1;
+        if (state) {
+            Nan::ThrowRangeError("expect 1st argument holding a pointer");
+        }
+    }
     v8::Isolate* isolate;
     isolate = info.GetIsolate();
     v8::Local<Context> ctx = isolate->GetCurrentContext();
 
     if (state == 0) {
-        int32_t offset = 0;
-        v8::Maybe<int32_t> offsetMaybe = info[1]->Int32Value(ctx);
+        int64_t offset = 0;
+        v8::Maybe<int64_t> offsetMaybe = info[1]->IntegerValue(ctx);
         if (offsetMaybe.IsJust()) {
             offset = offsetMaybe.FromJust();
         }
@@ -750,13 +1823,726 @@ NAN_METHOD(AddOffset) {
     }
 }
 
+/*
+ * A movable pointer into an array of "stride" sized elements. The cursor
+ * keeps a 64-bit byte position from the start of the array, so walking the
+ * array and reading or writing fields at the cursor allocates no JS object.
+ * When created with an element count, every access is checked against it.
+ */
+
+class PointerCursor : public Nan::ObjectWrap {
+ public:
+  static void Init(Local<Object> target) {
+    Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(Nan::New<v8::String>("Cursor").ToLocalChecked());
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+
+    Nan::SetPrototypeMethod(tpl, "next", Next);
+    Nan::SetPrototypeMethod(tpl, "advance", Advance);
+    Nan::SetPrototypeMethod(tpl, "seek", Seek);
+    Nan::SetPrototypeMethod(tpl, "valid", Valid);
+    Nan::SetPrototypeMethod(tpl, "index", Index);
+    Nan::SetPrototypeMethod(tpl, "hexAddress", HexAddress);
+    Nan::SetPrototypeMethod(tpl, "readInt8", Read<int8_t>);
+    Nan::SetPrototypeMethod(tpl, "readUInt8", Read<uint8_t>);
+    Nan::SetPrototypeMethod(tpl, "readInt16", Read<int16_t>);
+    Nan::SetPrototypeMethod(tpl, "readUInt16", Read<uint16_t>);
+    Nan::SetPrototypeMethod(tpl, "readInt32", Read<int32_t>);
+    Nan::SetPrototypeMethod(tpl, "readUInt32", Read<uint32_t>);
+    Nan::SetPrototypeMethod(tpl, "readFloat", Read<float>);
+    Nan::SetPrototypeMethod(tpl, "readDouble", Read<double>);
+    Nan::SetPrototypeMethod(tpl, "readInt64", ReadInt64);
+    Nan::SetPrototypeMethod(tpl, "readUInt64", ReadUInt64);
+    Nan::SetPrototypeMethod(tpl, "readPointer", ReadPointer);
+    Nan::SetPrototypeMethod(tpl, "readCString", ReadCString);
+    Nan::SetPrototypeMethod(tpl, "writeInt8", Write<int8_t>);
+    Nan::SetPrototypeMethod(tpl, "writeUInt8", Write<uint8_t>);
+    Nan::SetPrototypeMethod(tpl, "writeInt16", Write<int16_t>);
+    Nan::SetPrototypeMethod(tpl, "writeUInt16", Write<uint16_t>);
+    Nan::SetPrototypeMethod(tpl, "writeInt32", Write<int32_t>);
+    Nan::SetPrototypeMethod(tpl, "writeUInt32", Write<uint32_t>);
+    Nan::SetPrototypeMethod(tpl, "writeFloat", Write<float>);
+    Nan::SetPrototypeMethod(tpl, "writeDouble", Write<double>);
+    Nan::SetPrototypeMethod(tpl, "writeInt64", WriteInt64);
+    Nan::SetPrototypeMethod(tpl, "writeUInt64", WriteUInt64);
+
+    Nan::Set(target, Nan::New<v8::String>("Cursor").ToLocalChecked(),
+      Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+ private:
+  PointerCursor(char *base, int64_t stride, int64_t limit)
+    : base_(base), position_(0), stride_(stride), limit_(limit) {
+  }
+
+  ~PointerCursor() {
+    buffer_.Reset();
+  }
+
+  /*
+   * Creates a cursor on the first element.
+   *
+   * info[0] - Buffer - the Buffer instance pointing to the array
+   * info[1] - Number - the size in bytes of each element
+   * info[2] - Number - optional - the number of elements; unbounded if omitted
+   * info[3] - Number - optional (0) - the offset from the "buf" buffer's address
+   */
+
+  static NAN_METHOD(New) {
+    if (!info.IsConstructCall()) {
+      return Nan::ThrowTypeError("Cursor: use the new operator");
+    }
+    Local<Value> buf = info[0];
+    if (!Buffer::HasInstance(buf)) {
+      return Nan::ThrowTypeError("Cursor: Buffer instance expected");
+    }
+    int64_t stride = GetInt64(info[1]);
+    if (stride < 0) {
+      return Nan::ThrowRangeError("Cursor: invalid stride");
+    }
+    int64_t limit = -1;
+    if (!info[2]->IsNullOrUndefined()) {
+      int64_t count = GetInt64(info[2]);
+      if (count < 0 || (stride != 0 && count > INT64_MAX / stride)) {
+        return Nan::ThrowRangeError("Cursor: invalid element count");
+      }
+      limit = count * stride;
+    }
+    char *base = Buffer::Data(buf.As<Object>()) + GetInt64(info[3]);
+    if (base == NULL) {
+      return Nan::ThrowError("Cursor: Cannot walk a NULL pointer");
+    }
+
+    PointerCursor *cursor = new PointerCursor(base, stride, limit);
+    cursor->buffer_.Reset(buf.As<Object>());
+    cursor->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  /*
+   * Returns the address of the field "info[index]" bytes past the cursor, or
+   * NULL after throwing if "size" bytes there are out of bounds.
+   */
+
+  static char *At(const Nan::FunctionCallbackInfo<v8::Value>& info, int index,
+    size_t size) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    int64_t position;
+    if (!MulAdd(cursor->position_, GetInt64(info[index]), 1, &position) ||
+      position < 0 || (cursor->limit_ >= 0 && (position > cursor->limit_ ||
+      size > static_cast<uint64_t>(cursor->limit_ - position)))) {
+      Nan::ThrowRangeError("Cursor: access out of bounds");
+      return NULL;
+    }
+    return cursor->base_ + position;
+  }
+
+  /*
+   * Sets "*out" to "a + b * c", for a non-negative "c", returning false if
+   * that overflows.
+   */
+
+  static bool MulAdd(int64_t a, int64_t b, int64_t c, int64_t *out) {
+    if (c != 0 && (b > INT64_MAX / c || b < INT64_MIN / c)) {
+      return false;
+    }
+    int64_t product = b * c;
+    if ((product > 0 && a > INT64_MAX - product) ||
+      (product < 0 && a < INT64_MIN - product)) {
+      return false;
+    }
+    *out = a + product;
+    return true;
+  }
+
+  /*
+   * Moves the cursor to the byte position "a + b * c" and returns whether it
+   * is valid there, or throws if that position overflows.
+   */
+
+  static void MoveTo(const Nan::FunctionCallbackInfo<v8::Value>& info,
+    int64_t a, int64_t b, int64_t c) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    if (!MulAdd(a, b, c, &cursor->position_)) {
+      return Nan::ThrowRangeError("Cursor: position out of range");
+    }
+    info.GetReturnValue().Set(cursor->IsValid());
+  }
+
+  /*
+   * Returns "true" if the cursor is on an element of the array.
+   */
+
+  bool IsValid() const {
+    return position_ >= 0 && (limit_ < 0 || position_ < limit_);
+  }
+
+  /*
+   * Moves to the next element, returning whether the cursor is still valid.
+   */
+
+  static NAN_METHOD(Next) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    MoveTo(info, cursor->position_, 1, cursor->stride_);
+  }
+
+  /*
+   * Moves by "info[0]" elements, which may be negative, returning whether the
+   * cursor is still valid.
+   */
+
+  static NAN_METHOD(Advance) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    MoveTo(info, cursor->position_, GetInt64(info[0]), cursor->stride_);
+  }
+
+  /*
+   * Moves to the element at index "info[0]", returning whether the cursor is
+   * valid there.
+   */
+
+  static NAN_METHOD(Seek) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    MoveTo(info, 0, GetInt64(info[0]), cursor->stride_);
+  }
+
+  static NAN_METHOD(Valid) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    info.GetReturnValue().Set(cursor->IsValid());
+  }
+
+  static NAN_METHOD(Index) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    int64_t index = cursor->stride_ ? cursor->position_ / cursor->stride_ : 0;
+    info.GetReturnValue().Set(static_cast<double>(index));
+  }
+
+  static NAN_METHOD(HexAddress) {
+    PointerCursor *cursor = Nan::ObjectWrap::Unwrap<PointerCursor>(info.This());
+    char strbuf[30]; /* should be plenty... */
+    std::snprintf(strbuf, 30, "%p", cursor->base_ + cursor->position_);
+    const char *val = strbuf;
+    if (strbuf[0] == '0' && strbuf[1] == 'x') {
+      /* strip the leading "0x" from the address */
+      val += 2;
+    }
+    info.GetReturnValue().Set(Nan::New<v8::String>(val).ToLocalChecked());
+  }
+
+  /*
+   * Reads a machine-endian "T" at the cursor.
+   *
+   * info[0] - Number - optional (0) - the offset of the field in the element
+   */
+
+  template <typename T>
+  static NAN_METHOD(Read) {
+    char *ptr = At(info, 0, sizeof(T));
+    if (ptr == NULL) return;
+    T val;
+    std::memcpy(&val, ptr, sizeof(T));
+    info.GetReturnValue().Set(static_cast<double>(val));
+  }
+
+  /*
+   * Writes the Number as a machine-endian "T" at the cursor.
+   *
+   * info[0] - Number - the value to write
+   * info[1] - Number - optional (0) - the offset of the field in the element
+   */
+
+  template <typename T>
+  static NAN_METHOD(Write) {
+    char *ptr = At(info, 1, sizeof(T));
+    if (ptr == NULL) return;
+    T val;
+    if constexpr (std::is_integral<T>::value) {
+      // wraps around like the typed arrays do
+      val = static_cast<T>(GetInt64(info[0]));
+    } else {
+      val = static_cast<T>(Nan::To<double>(info[0]).FromMaybe(0));
+    }
+    std::memcpy(ptr, &val, sizeof(T));
+  }
+
+  static NAN_METHOD(ReadInt64) {
+    char *ptr = At(info, 0, sizeof(int64_t));
+    if (ptr == NULL) return;
+    int64_t val;
+    std::memcpy(&val, ptr, sizeof(val));
+    info.GetReturnValue().Set(NewInt64Value(val));
+  }
+
+  static NAN_METHOD(ReadUInt64) {
+    char *ptr = At(info, 0, sizeof(uint64_t));
+    if (ptr == NULL) return;
+    uint64_t val;
+    std::memcpy(&val, ptr, sizeof(val));
+    info.GetReturnValue().Set(NewUInt64Value(val));
+  }
+
+  static NAN_METHOD(WriteInt64) {
+    char *ptr = At(info, 1, sizeof(int64_t));
+    if (ptr == NULL) return;
+    int64_t val;
+    if (!ToInt64("writeInt64", info[0], &val)) return;
+    std::memcpy(ptr, &val, sizeof(val));
+  }
+
+  static NAN_METHOD(WriteUInt64) {
+    char *ptr = At(info, 1, sizeof(uint64_t));
+    if (ptr == NULL) return;
+    uint64_t val;
+    if (!ToUInt64("writeUInt64", info[0], &val)) return;
+    std::memcpy(ptr, &val, sizeof(val));
+  }
+
+  /*
+   * Reads the pointer field at the cursor as a Buffer of the given size.
+   *
+   * info[0] - Number - optional (0) - the offset of the field in the element
+   * info[1] - Number - optional (0) - the length in bytes of the returned Buffer
+   */
+
+  static NAN_METHOD(ReadPointer) {
+    char *ptr = At(info, 0, sizeof(char *));
+    if (ptr == NULL) return;
+    char *val;
+    std::memcpy(&val, ptr, sizeof(val));
+    size_t size = static_cast<size_t>(GetInt64(info[1]));
+    info.GetReturnValue().Set(WrapPointer(val, size));
+  }
+
+  /*
+   * Reads the `char *` field at the cursor as a JS String, or null.
+   *
+   * info[0] - Number - optional (0) - the offset of the field in the element
+   */
+
+  static NAN_METHOD(ReadCString) {
+    char *ptr = At(info, 0, sizeof(char *));
+    if (ptr == NULL) return;
+    char *val;
+    std::memcpy(&val, ptr, sizeof(val));
+    if (val == NULL) {
+      return info.GetReturnValue().SetNull();
+    }
+    info.GetReturnValue().Set(Nan::New<v8::String>(val).ToLocalChecked());
+  }
+
+  char *base_;
+  int64_t position_;
+  int64_t stride_;
+  int64_t limit_;
+  // keeps the memory the cursor walks alive
+  Nan::Persistent<Object> buffer_;
+};
+
+/*
+ * Tells V8 that "change" bytes of native memory are now kept alive by
+ * Buffers (or released, when negative). Unlike Nan::AdjustExternalMemory()
+ * this takes the full 64-bit amount.
+ */
+
+inline void AdjustExternalMemory(int64_t change) {
+  v8::Isolate::GetCurrent()->AdjustAmountOfExternalAllocatedMemory(change);
+}
+
+/*
+ * Bookkeeping for the memory handed out by `malloc()` and `alignedAlloc()`.
+ * "base" is what std::malloc() returned; the Buffer data may sit past it to
+ * honour the requested alignment.
+ */
+
+struct NativeAllocation {
+  char *base;
+  size_t size;
+};
+
+/*
+ * Called once the Buffer from `AllocateNative()` is garbage collected or
+ * detached by `Free()`. Releases the memory and tells V8 it is gone.
+ */
+
+void native_allocation_cb(char *data, void *hint) {
+  NativeAllocation *allocation = reinterpret_cast<NativeAllocation *>(hint);
+  AdjustExternalMemory(-static_cast<int64_t>(allocation->size));
+  std::free(allocation->base);
+  delete allocation;
+}
+
+/*
+ * Allocates "size" uninitialized bytes aligned to "alignment" (a power of 2)
+ * and returns them as a Buffer that owns the memory. Alignments beyond the
+ * one of std::malloc() cost "alignment - 1" bytes of padding.
+ */
+
+inline Local<Value> AllocateNative(size_t size, size_t alignment) {
+  Nan::EscapableHandleScope scope;
+  if (alignment <= alignof(std::max_align_t)) {
+    alignment = 1;
+  }
+  size_t total = size + alignment - 1;
+  char *base = static_cast<char *>(std::malloc(total > 0 ? total : 1));
+  if (base == NULL) {
+    return scope.Escape(Local<Value>());
+  }
+  uintptr_t addr = reinterpret_cast<uintptr_t>(base);
+  char *ptr = base + ((alignment - addr % alignment) % alignment);
+
+  NativeAllocation *allocation = new NativeAllocation();
+  allocation->base = base;
+  allocation->size = total;
+  AdjustExternalMemory(static_cast<int64_t>(total));
+
+  return scope.Escape(Nan::NewBuffer(ptr, size,
+    native_allocation_cb, allocation).ToLocalChecked());
+}
+
+/*
+ * Returns a new Buffer of "size" uninitialized bytes from the C heap, aligned
+ * for any fundamental type. The memory is reported to V8 as external memory
+ * and released when the Buffer is garbage collected or passed to `free()`.
+ *
+ * info[0] - Number - the size in bytes of the returned Buffer
+ */
+
+NAN_METHOD(Malloc) {
+  REF_STATS_CALL(malloc);
+
+  int64_t size = GetInt64(info[0]);
+  if (size < 0 || size > kMaxLength) {
+    return Nan::ThrowRangeError("malloc: invalid size");
+  }
+
+  // std::malloc() is already aligned for any fundamental type, no padding
+  Local<Value> rtn = AllocateNative(static_cast<size_t>(size), 1);
+  if (rtn.IsEmpty()) {
+    return Nan::ThrowError("malloc: out of memory");
+  }
+  info.GetReturnValue().Set(rtn);
+}
+
+/*
+ * Same as `Malloc()`, but the returned Buffer's address is a multiple of the
+ * given alignment.
+ *
+ * info[0] - Number - the size in bytes of the returned Buffer
+ * info[1] - Number - the alignment in bytes, a power of 2
+ */
+
+NAN_METHOD(AlignedAlloc) {
+  REF_STATS_CALL(alignedAlloc);
+
+  int64_t size = GetInt64(info[0]);
+  int64_t alignment = GetInt64(info[1]);
+  if (size < 0 || size > kMaxLength) {
+    return Nan::ThrowRangeError("alignedAlloc: invalid size");
+  }
+  if (alignment <= 0 || alignment > kMaxAlignment ||
+    (alignment & (alignment - 1)) != 0) {
+    return Nan::ThrowRangeError(
+      "alignedAlloc: alignment must be a power of 2 up to 65536");
+  }
+
+  Local<Value> rtn = AllocateNative(static_cast<size_t>(size),
+    static_cast<size_t>(alignment));
+  if (rtn.IsEmpty()) {
+    return Nan::ThrowError("alignedAlloc: out of memory");
+  }
+  info.GetReturnValue().Set(rtn);
+}
+
+/*
+ * Detaches the memory of a Buffer returned by `malloc()` or `alignedAlloc()`,
+ * which releases it without waiting for the garbage collector. The Buffer
+ * (and any view of it) has a length of 0 afterwards.
+ *
+ * info[0] - Buffer - the Buffer instance to release
+ */
+
+NAN_METHOD(Free) {
+  REF_STATS_CALL(free);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("free: Buffer instance expected");
+  }
+
+  Local<ArrayBuffer> ab = buf.As<Uint8Array>()->Buffer();
+  if (!ab->IsDetachable()) {
+    return Nan::ThrowError("free: Buffer memory cannot be released");
+  }
+#if defined(V8_MAJOR_VERSION) && V8_MAJOR_VERSION >= 11
+  ab->Detach(Local<Value>()).Check();
+#else
+  ab->Detach();
+#endif
+
+  info.GetReturnValue().SetUndefined();
+}
+
+/*
+ * Bookkeeping for the native memory adopted by `reinterpretOwned()` and
+ * `readPointerOwned()`. Exactly one of "free1" and "free2" is set.
+ */
+
+struct OwnedPointer {
+  void (*free1)(void *);
+  void (*free2)(void *, void *);
+  void *hint;
+  size_t size;
+};
+
+/*
+ * Called once an owned Buffer is garbage collected or detached by `Free()`.
+ * Hands the memory to its deallocator and tells V8 it is gone.
+ */
+
+void owned_pointer_cb(char *data, void *hint) {
+  OwnedPointer *owned = reinterpret_cast<OwnedPointer *>(hint);
+  AdjustExternalMemory(-static_cast<int64_t>(owned->size));
+  if (owned->free2 != NULL) {
+    owned->free2(data, owned->hint);
+  } else {
+    owned->free1(data);
+  }
+  delete owned;
+}
+
+/*
+ * Fills "owned" from the deallocator arguments of the owned bindings:
+ * "deallocator" is a Buffer pointing to a `void (*)(void *)` function, or
+ * `null` for the C library's free(). When "hint" is a Buffer, the
+ * deallocator is a `void (*)(void *, void *)` function instead and gets its
+ * address as the second argument. Throws and returns false otherwise.
+ */
+
+inline bool GetDeallocator(const char *name, Local<Value> deallocator,
+  Local<Value> hint, OwnedPointer *owned) {
+  char errmsg[200];
+  bool custom = !deallocator->IsUndefined() && !deallocator->IsNull();
+  owned->free1 = std::free;
+  owned->free2 = NULL;
+  owned->hint = NULL;
+
+  if (custom && (!Buffer::HasInstance(deallocator) ||
+    Buffer::Data(deallocator.As<Object>()) == NULL)) {
+    snprintf(errmsg, sizeof(errmsg),
+      "%s: deallocator must be a function pointer Buffer", name);
+    Nan::ThrowTypeError(errmsg);
+    return false;
+  }
+
+  if (hint->IsUndefined()) {
+    if (custom) {
+      owned->free1 = reinterpret_cast<void (*)(void *)>(
+        Buffer::Data(deallocator.As<Object>()));
+    }
+  } else {
+    if (!custom || !Buffer::HasInstance(hint)) {
+      snprintf(errmsg, sizeof(errmsg),
+        "%s: hint must be a Buffer and requires a deallocator", name);
+      Nan::ThrowTypeError(errmsg);
+      return false;
+    }
+    owned->free1 = NULL;
+    owned->free2 = reinterpret_cast<void (*)(void *, void *)>(
+      Buffer::Data(deallocator.As<Object>()));
+    owned->hint = Buffer::Data(hint.As<Object>());
+  }
+  return true;
+}
+
+/*
+ * Wraps "ptr" in a Buffer of "size" bytes that owns the memory. The size is
+ * reported to V8 as external memory until the deallocator runs.
+ */
+
+inline Local<Value> WrapOwnedPointer(char *ptr, size_t size,
+  const OwnedPointer &deallocator) {
+  REF_TRACE_SCOPE1("WrapOwnedPointer", "size", size);
+  Nan::EscapableHandleScope scope;
+  OwnedPointer *owned = new OwnedPointer(deallocator);
+  owned->size = size;
+  AdjustExternalMemory(static_cast<int64_t>(size));
+  return scope.Escape(Nan::NewBuffer(ptr, size,
+    owned_pointer_cb, owned).ToLocalChecked());
+}
+
+/*
+ * Same as `ReinterpretBuffer()`, but the returned Buffer takes ownership of
+ * the memory and releases it with the given deallocator.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to read the address from
+ * info[1] - Number - the size in bytes that the returned Buffer should be
+ * info[2] - Number - the offset from the "buf" buffer's address to read from
+ * info[3] - Buffer - the deallocator function pointer, or null for free()
+ * info[4] - Buffer - the hint passed to the deallocator (optional)
+ */
+
+template <bool kChecked>
+NAN_METHOD(ReinterpretOwned) {
+  REF_STATS_CALL(reinterpretOwned);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("reinterpretOwned: Buffer instance expected");
+  }
+
+  int64_t offset = GetInt64(info[2]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("reinterpretOwned", buf, offset, 0, 1, &ptr)) {
+    return;
+  }
+  if (ptr == NULL) {
+    return Nan::ThrowError("reinterpretOwned: Cannot reinterpret from NULL pointer");
+  }
+
+  OwnedPointer owned;
+  if (!GetDeallocator("reinterpretOwned", info[3], info[4], &owned)) {
+    return;
+  }
+  size_t size = Nan::To<uint32_t>(info[1]).FromJust();
+  if (size > kMaxLength) {
+    return Nan::ThrowRangeError("reinterpretOwned: invalid size");
+  }
+
+  info.GetReturnValue().Set(WrapOwnedPointer(ptr, size, owned));
+}
+
+/*
+ * Same as `ReadPointer()`, but the returned Buffer takes ownership of the
+ * memory it points to and releases it with the given deallocator. A NULL
+ * pointer yields a NULL Buffer that owns nothing.
+ *
+ * info[0] - Buffer - the "buf" Buffer instance to read from
+ * info[1] - Number - the offset from the "buf" buffer's address to read from
+ * info[2] - Number - the length in bytes of the returned Buffer
+ * info[3] - Buffer - the deallocator function pointer, or null for free()
+ * info[4] - Buffer - the hint passed to the deallocator (optional)
+ */
+
+template <bool kChecked>
+NAN_METHOD(ReadPointerOwned) {
+  REF_STATS_CALL(readPointerOwned);
+
+  Local<Value> buf = info[0];
+  if (!Buffer::HasInstance(buf)) {
+    return Nan::ThrowTypeError("readPointerOwned: Buffer instance expected as first argument");
+  }
+
+  int64_t offset = GetInt64(info[1]);
+  char *ptr;
+  if (!GetBufferPointer<kChecked>("readPointerOwned", buf, offset, sizeof(char *), alignof(char *), &ptr)) {
+    return;
+  }
+  if (ptr == NULL) {
+    return Nan::ThrowError("readPointerOwned: Cannot read from NULL pointer");
+  }
+
+  OwnedPointer owned;
+  if (!GetDeallocator("readPointerOwned", info[3], info[4], &owned)) {
+    return;
+  }
+  size_t size = Nan::To<uint32_t>(info[2]).FromJust();
+  if (size > kMaxLength) {
+    return Nan::ThrowRangeError("readPointerOwned: invalid size");
+  }
+
+  char *val = *reinterpret_cast<char **>(ptr);
+  if (val == NULL) {
+    info.GetReturnValue().Set(WrapNullPointer());
+  } else {
+    info.GetReturnValue().Set(WrapOwnedPointer(val, size, owned));
+  }
+}
+
+#ifdef REF_ENABLE_STATS
+
+inline void SetCounter(Local<Object> obj, const char *name, uint64_t val) {
+  Nan::Set(obj, Nan::New<v8::String>(name).ToLocalChecked(),
+    Nan::New<v8::Number>(static_cast<double>(val)));
+}
+
+/*
+ * Returns a snapshot of the runtime counters of the calling thread.
+ */
+
+NAN_METHOD(Stats) {
+
+  Local<Object> rtn = Nan::New<v8::Object>();
+  Local<Object> calls = Nan::New<v8::Object>();
+  for (int i = 0; i < kStatCount; i++) {
+    SetCounter(calls, kStatNames[i], ref_stats.calls[i]);
+  }
+  Nan::Set(rtn, Nan::New<v8::String>("calls").ToLocalChecked(), calls);
+  SetCounter(rtn, "bytesScanned", ref_stats.bytesScanned);
+  SetCounter(rtn, "bytesCopied", ref_stats.bytesCopied);
+
+  Local<Object> wrapped = Nan::New<v8::Object>();
+  SetCounter(wrapped, "live", ref_stats.wrappedLive);
+  SetCounter(wrapped, "liveBytes", ref_stats.wrappedLiveBytes);
+  SetCounter(wrapped, "total", ref_stats.wrappedTotal);
+  Nan::Set(rtn, Nan::New<v8::String>("wrappedPointers").ToLocalChecked(),
+    wrapped);
+
+  Local<Object> handles = Nan::New<v8::Object>();
+  SetCounter(handles, "created", ref_stats.globalHandlesCreated);
+  SetCounter(handles, "collected", ref_stats.globalHandlesCollected);
+  Nan::Set(rtn, Nan::New<v8::String>("globalHandles").ToLocalChecked(),
+    handles);
+
+  if (ref_stats.histogram) {
+    Local<Object> latency = Nan::New<v8::Object>();
+    for (int i = 0; i < kStatCount; i++) {
+      if (ref_stats.calls[i] == 0) continue;
+      Local<v8::Array> buckets = Nan::New<v8::Array>(kHistogramBuckets);
+      for (int j = 0; j < kHistogramBuckets; j++) {
+        Nan::Set(buckets, j,
+          Nan::New<v8::Number>(static_cast<double>(ref_stats.latency[i][j])));
+      }
+      Nan::Set(latency, Nan::New<v8::String>(kStatNames[i]).ToLocalChecked(),
+        buckets);
+    }
+    Nan::Set(rtn, Nan::New<v8::String>("latency").ToLocalChecked(), latency);
+  }
+
+  info.GetReturnValue().Set(rtn);
+}
+
+/*
+ * Zeroes the call, byte and latency counters of the calling thread. The
+ * live wrapped pointer gauges are kept since those Buffers are still alive.
+ *
+ * info[0] - Boolean - optional - turn the latency histogram on or off
+ */
+
+NAN_METHOD(ResetStats) {
+
+  uint64_t live = ref_stats.wrappedLive;
+  uint64_t liveBytes = ref_stats.wrappedLiveBytes;
+  bool histogram = ref_stats.histogram;
+  if (info.Length() > 0 && !info[0]->IsUndefined()) {
+    histogram = info[0]->ToBoolean(info.GetIsolate())->IsTrue();
+  }
+  std::memset(&ref_stats, 0, sizeof(ref_stats));
+  ref_stats.wrappedLive = live;
+  ref_stats.wrappedLiveBytes = liveBytes;
+  ref_stats.histogram = histogram;
+
+  info.GetReturnValue().SetUndefined();
+}
 
+#endif // REF_ENABLE_STATS
 
 } // anonymous namespace
 
 NAN_MODULE_INIT(init) {
   Nan::HandleScope scope;
 
+  InitTracing();
+
   // "sizeof" map
   Local<Object> smap = Nan::New<v8::Object>();
   // fixed sizes
@@ -836,21 +2622,24 @@ NAN_MODULE_INIT(init) {
     target, Nan::New<v8::String>("NULL").ToLocalChecked(),
     WrapNullPointer(),
     static_cast<PropertyAttribute>(ReadOnly|DontDelete));
-  Nan::SetMethod(target, "address", Address);
-  Nan::SetMethod(target, "hexAddress", HexAddress);
-  Nan::SetMethod(target, "isNull", IsNull);
-  Nan::SetMethod(target, "readObject", ReadObject);
-  Nan::SetMethod(target, "writeObject", WriteObject);
-  Nan::SetMethod(target, "readPointer", ReadPointer);
-  Nan::SetMethod(target, "writePointer", WritePointer);
-  Nan::SetMethod(target, "readInt64", ReadInt64);
-  Nan::SetMethod(target, "writeInt64", WriteInt64);
-  Nan::SetMethod(target, "readUInt64", ReadUInt64);
-  Nan::SetMethod(target, "writeUInt64", WriteUInt64);
-  Nan::SetMethod(target, "readCString", ReadCString);
-  Nan::SetMethod(target, "reinterpret", ReinterpretBuffer);
-  Nan::SetMethod(target, "reinterpretUntilZeros", ReinterpretBufferUntilZeros);
-  Nan::SetMethod(target, "copyMemory", CopyMemoryI);
-  Nan::SetMethod(target, "addOffset", AddOffset);
+#define SET_METHOD(name, fn) Nan::SetMethod(target, #name, fn);
+  REF_BINDINGS(SET_METHOD)
+#undef SET_METHOD
+  Local<Object> checked = Nan::New<v8::Object>();
+  Local<Object> unchecked = Nan::New<v8::Object>();
+#define SET_VARIANTS(name, fn) \
+  Nan::SetMethod(target, #name, fn<REF_DEFAULT_VARIANT>); \
+  Nan::SetMethod(checked, #name, fn<true>); \
+  Nan::SetMethod(unchecked, #name, fn<false>);
+  REF_CHECKED_BINDINGS(SET_VARIANTS)
+#undef SET_VARIANTS
+  Nan::Set(target, Nan::New<v8::String>("checked").ToLocalChecked(), checked);
+  Nan::Set(target, Nan::New<v8::String>("unchecked").ToLocalChecked(),
+    unchecked);
+  PointerCursor::Init(target);
+#ifdef REF_ENABLE_STATS
+  Nan::SetMethod(target, "stats", Stats);
+  Nan::SetMethod(target, "resetStats", ResetStats);
+#endif
 }
 NAN_MODULE_WORKER_ENABLED(binding, init)
@@ -0,0 +1,137 @@
+
+var assert = require('assert')
+var path = require('path')
+var spawnSync = require('child_process').spawnSync
+var ref = require('../')
+
+describe('checked bindings', function () {
+
+  it('should export the same bindings in both variants', function () {
+    assert.deepEqual(Object.keys(ref.checked).sort(), Object.keys(ref.unchecked).sort())
+    assert(Object.keys(ref.checked).length > 0)
+  })
+
+  it('should behave like the unchecked variant for valid accesses', function () {
+    var buf = Buffer.alloc(16)
+    ref.checked.writeInt64(buf, 8, '-1234567890123')
+    assert.equal(ref.unchecked.readInt64(buf, 8), ref.checked.readInt64(buf, 8))
+    assert.equal(ref.checked.readInt64(buf, 8), -1234567890123)
+  })
+
+  it('should throw a RangeError for an access past the end', function () {
+    assert.throws(function () {
+      ref.checked.readInt64(Buffer.alloc(12), 8)
+    }, /readInt64: offset 8 \+ 8 bytes is out of bounds of a 12 byte Buffer/)
+  })
+
+  it('should throw a RangeError for a negative offset', function () {
+    assert.throws(function () {
+      ref.checked.readPointer(Buffer.alloc(16), -8, 0)
+    }, RangeError)
+  })
+
+  it('should throw a RangeError for a misaligned access', function () {
+    var buf = Buffer.alloc(24)
+    var base = parseInt(buf.hexAddress(), 16) % 8
+    assert.throws(function () {
+      ref.checked.writePointer(buf, 9 - base, ref.NULL)
+    }, /is not aligned/)
+  })
+
+  it('should throw a RangeError for columns past the end', function () {
+    var column = new Float64Array(1000)
+    assert.throws(function () {
+      ref.checked.writeColumns(Buffer.alloc(8), 0, 1000, 24, [
+        { offset: 0, type: ref.types.double, column: column }
+      ])
+    }, RangeError)
+    assert.throws(function () {
+      ref.checked.readColumns(Buffer.alloc(32), 0, 2, 24, [
+        { offset: 16, type: ref.types.double }
+      ])
+    }, RangeError)
+  })
+
+  it('should allow columns that end exactly at the end', function () {
+    var cols = ref.checked.readColumns(Buffer.alloc(32), 0, 2, 24, [
+      { offset: 0, type: ref.types.double }
+    ])
+    assert.equal(cols[0].length, 2)
+  })
+
+  it('should attach the pointed to Buffer in writePointer()', function () {
+    ;[ ref.checked, ref.unchecked ].forEach(function (variant) {
+      var buf = Buffer.alloc(ref.sizeof.pointer)
+      var target = Buffer.from('hello')
+      variant.writePointer(buf, 0, target)
+      assert.equal(buf._refs[0], target)
+    })
+  })
+
+  it('should attach the source Buffer in reinterpret()', function () {
+    ;[ ref.checked, ref.unchecked ].forEach(function (variant) {
+      var buf = Buffer.from('hello\0')
+      assert.equal(variant.reinterpret(buf, 2)._refs[0], buf)
+      assert.equal(variant.reinterpretUntilZeros(buf, 1)._refs[0], buf)
+    })
+  })
+
+  it('should read C strings within the Buffer', function () {
+    var buf = Buffer.from('hello\0world\0')
+    assert.equal(ref.checked.readCString(buf, 0), 'hello')
+    assert.equal(ref.checked.readCString(buf, 6), 'world')
+  })
+
+  it('should throw when no terminator lies within the Buffer', function () {
+    var buf = Buffer.from('hello\0')
+    var ptr = ref.reinterpret(buf, 5)
+    assert.throws(function () {
+      ref.checked.readCString(ptr, 0)
+    }, /no terminator/)
+    assert.throws(function () {
+      ref.checked.readWString(Buffer.from([ 0x41, 0, 0x42, 0 ]), 0, 2)
+    }, RangeError)
+    assert.throws(function () {
+      ref.checked.reinterpretUntilZeros(ptr, 1)
+    }, RangeError)
+  })
+
+  it('should scan past the end of a zero length pointer Buffer', function () {
+    var buf = Buffer.from('hello\0')
+    var ptr = ref.reinterpret(buf, 0)
+    assert.equal(ref.checked.readCString(ptr, 0), 'hello')
+    assert.equal(ref.checked.reinterpretUntilZeros(ptr, 1).length, 5)
+  })
+
+  it('should stop at a terminator that ends the Buffer', function () {
+    var buf = Buffer.from('hi\0')
+    assert.equal(ref.checked.reinterpretUntilZeros(buf, 1).length, 2)
+    assert.equal(ref.checked.readWString(Buffer.from([ 0x41, 0, 0, 0 ]), 0, 2), 'A')
+  })
+
+  describe('REF_CHECKED', function () {
+
+    // prints which variant the module level readInt64() is
+    function variantWith (value) {
+      var script = [
+        'var ref = require(' + JSON.stringify(path.resolve(__dirname, '..')) + ')',
+        'console.log(ref.readInt64 === ref.checked.readInt64 ? "checked"',
+        '  : ref.readInt64 === ref.unchecked.readInt64 ? "unchecked" : "?")'
+      ].join('\n')
+      var env = Object.assign({}, process.env, { REF_CHECKED: value })
+      var child = spawnSync(process.execPath, [ '-e', script ], { env: env })
+      assert.equal(child.status, 0, String(child.stderr))
+      return String(child.stdout).trim()
+    }
+
+    it('should select the checked variant with REF_CHECKED=1', function () {
+      assert.equal(variantWith('1'), 'checked')
+    })
+
+    it('should select the unchecked variant with REF_CHECKED=0', function () {
+      assert.equal(variantWith('0'), 'unchecked')
+    })
+
+  })
+
+})
@@ -0,0 +1,141 @@
+
+var assert = require('assert')
+var ref = require('../')
+
+describe('columns', function () {
+
+  // struct row { int32_t id; uint8_t flag; double value; int64_t big; }
+  var stride = 24
+  var fields = [
+      { offset: 0, type: ref.types.int32 }
+    , { offset: 4, type: ref.types.bool }
+    , { offset: 8, type: ref.types.double }
+    , { offset: 16, type: ref.types.int64 }
+  ]
+
+  function rows (count) {
+    var buf = Buffer.alloc(count * stride)
+    for (var i = 0; i < count; i++) {
+      ref.set(buf, i * stride, -i, ref.types.int32)
+      ref.set(buf, i * stride + 4, i % 2, ref.types.uint8)
+      ref.set(buf, i * stride + 8, i / 4, ref.types.double)
+      ref.set(buf, i * stride + 16, i * 1000, ref.types.int64)
+    }
+    return buf
+  }
+
+  describe('readColumns()', function () {
+
+    it('should decode one typed array per field', function () {
+      var buf = rows(5)
+      var cols = ref.readColumns(buf, 0, 5, stride, fields)
+      assert(cols[0] instanceof Int32Array)
+      assert(cols[1] instanceof Uint8Array)
+      assert(cols[2] instanceof Float64Array)
+      assert(cols[3] instanceof BigInt64Array)
+      for (var i = 0; i < 5; i++) {
+        assert.equal(cols[0][i], -i)
+        assert.equal(cols[1][i], i % 2)
+        assert.equal(cols[2][i], i / 4)
+        assert.equal(cols[3][i], BigInt(i * 1000))
+      }
+    })
+
+    it('should fill a preallocated column', function () {
+      var buf = rows(3)
+      var column = new Int32Array(3)
+      var cols = ref.readColumns(buf, stride, 2, stride, [
+        { offset: 0, type: 'int', column: column }
+      ])
+      assert.strictEqual(cols[0], column)
+      assert.deepEqual(Array.from(column), [ -1, -2, 0 ])
+    })
+
+    it('should throw for a column of the wrong type', function () {
+      assert.throws(function () {
+        ref.readColumns(rows(1), 0, 1, stride, [
+          { offset: 0, type: ref.types.int32, column: new Float32Array(1) }
+        ])
+      }, TypeError)
+    })
+
+    it('should name a type given as a string in the column error', function () {
+      assert.throws(function () {
+        ref.readColumns(rows(1), 0, 1, stride, [
+          { offset: 0, type: 'int32', column: new Float32Array(1) }
+        ])
+      }, /column for "int32"/)
+    })
+
+    it('should throw for a column shorter than the row count', function () {
+      assert.throws(function () {
+        ref.readColumns(rows(2), 0, 2, stride, [
+          { offset: 0, type: ref.types.int32, column: new Int32Array(1) }
+        ])
+      }, RangeError)
+    })
+
+    it('should throw for pointer types', function () {
+      assert.throws(function () {
+        ref.readColumns(rows(1), 0, 1, stride, [
+          { offset: 0, type: 'int *' }
+        ])
+      }, TypeError)
+    })
+
+  })
+
+  describe('field offsets', function () {
+
+    it('should throw for a negative field offset', function () {
+      assert.throws(function () {
+        ref.readColumns(rows(2), 0, 2, stride, [
+          { offset: -4, type: ref.types.int32 }
+        ])
+      }, RangeError)
+    })
+
+    it('should throw for a field reaching into the next struct', function () {
+      assert.throws(function () {
+        ref.readColumns(rows(2), 0, 2, stride, [
+          { offset: 20, type: ref.types.double }
+        ])
+      }, RangeError)
+      assert.throws(function () {
+        ref.writeColumns(rows(2), 0, 2, stride, [
+          { offset: 24, type: ref.types.int8, column: new Int8Array(2) }
+        ])
+      }, RangeError)
+    })
+
+    it('should throw for a negative buffer offset', function () {
+      assert.throws(function () {
+        ref.readColumns(rows(2), -stride, 1, stride, [
+          { offset: 0, type: ref.types.int32 }
+        ])
+      }, RangeError)
+    })
+
+    it('should check the field offsets natively too', function () {
+      assert.throws(function () {
+        ref._readColumns(rows(2), 0, 2, stride, [ [ 20, new Float64Array(2) ] ])
+      }, RangeError)
+    })
+
+  })
+
+  describe('writeColumns()', function () {
+
+    it('should round trip with readColumns()', function () {
+      var buf = rows(4)
+      var cols = ref.readColumns(buf, 0, 4, stride, fields)
+      var out = Buffer.alloc(buf.length)
+      ref.writeColumns(out, 0, 4, stride, fields.map(function (field, i) {
+        return { offset: field.offset, type: field.type, column: cols[i] }
+      }))
+      assert.deepEqual(out, buf)
+    })
+
+  })
+
+})
@@ -0,0 +1,63 @@
+
+var assert = require('assert')
+var ref = require('../')
+
+describe('allocCStringArray()', function () {
+
+  it('should return a "char **" Buffer', function () {
+    var buf = ref.allocCStringArray([ 'a' ])
+    assert.equal(buf.type.indirection, 3)
+    assert.strictEqual(ref.derefType(ref.derefType(buf.type)), ref.types.char)
+  })
+
+  it('should point each entry at its NUL terminated string', function () {
+    var strings = [ 'hello', 'wörld', '' ]
+    var buf = ref.allocCStringArray(strings)
+    strings.forEach(function (str, i) {
+      var ptr = ref.readPointer(buf, i * ref.sizeof.pointer, 0)
+      assert.equal(ref.readCString(ptr, 0), str)
+    })
+  })
+
+  it('should lay out the table and the strings in one Buffer', function () {
+    var buf = ref.allocCStringArray([ 'ab', 'cd' ])
+    var tableSize = 3 * ref.sizeof.pointer
+    assert.equal(buf.length, tableSize + 6)
+    assert.equal(buf.toString('utf8', tableSize), 'ab\0cd\0')
+  })
+
+  it('should end the table with a NULL pointer by default', function () {
+    var buf = ref.allocCStringArray([ 'a', 'b' ])
+    assert(ref.readPointer(buf, 2 * ref.sizeof.pointer, 0).isNull())
+  })
+
+  it('should omit the NULL pointer when asked to', function () {
+    var buf = ref.allocCStringArray([ 'a', 'b' ], 'utf8', false)
+    assert.equal(buf.length, 2 * ref.sizeof.pointer + 4)
+  })
+
+  it('should write NULL pointers for null entries', function () {
+    var buf = ref.allocCStringArray([ null, 'x' ])
+    assert(ref.readPointer(buf, 0, 0).isNull())
+    assert.equal(ref.readCString(ref.readPointer(buf, ref.sizeof.pointer, 0), 0), 'x')
+  })
+
+  it('should honour the encoding', function () {
+    var buf = ref.allocCStringArray([ 'é' ], 'latin1', false)
+    assert.equal(buf.length, ref.sizeof.pointer + 2)
+    assert.equal(buf[ref.sizeof.pointer], 0xe9)
+  })
+
+  it('should throw for non-string entries', function () {
+    assert.throws(function () {
+      ref.allocCStringArray([ 1 ])
+    }, TypeError)
+  })
+
+  it('should throw for a pointer table that is too long', function () {
+    assert.throws(function () {
+      ref.allocCStringArray(new Array(Math.pow(2, 28)))
+    }, RangeError)
+  })
+
+})
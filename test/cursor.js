@@ -0,0 +1,117 @@
+
+var assert = require('assert')
+var ref = require('../')
+
+describe('Cursor', function () {
+
+  // struct record { int32_t id; uint16_t flags; double value; }
+  var stride = 16
+
+  function records (count) {
+    var buf = Buffer.alloc(count * stride)
+    for (var i = 0; i < count; i++) {
+      ref.set(buf, i * stride, i + 1, ref.types.int32)
+      ref.set(buf, i * stride + 4, i * 2, ref.types.uint16)
+      ref.set(buf, i * stride + 8, i / 2, ref.types.double)
+    }
+    return buf
+  }
+
+  it('should walk every element with next()', function () {
+    var cursor = ref.cursor(records(4), stride, 4)
+    var ids = []
+    for (; cursor.valid(); cursor.next()) {
+      ids.push(cursor.readInt32(0))
+    }
+    assert.deepEqual(ids, [ 1, 2, 3, 4 ])
+    assert.equal(cursor.index(), 4)
+  })
+
+  it('should read fields at their offsets', function () {
+    var cursor = ref.cursor(records(3), stride, 3)
+    cursor.seek(2)
+    assert.equal(cursor.readUInt16(4), 4)
+    assert.equal(cursor.readDouble(8), 1)
+  })
+
+  it('should advance by several elements at once', function () {
+    var cursor = ref.cursor(records(10), stride, 10)
+    assert(cursor.advance(7))
+    assert.equal(cursor.readInt32(), 8)
+    assert(cursor.advance(-5))
+    assert.equal(cursor.readInt32(), 3)
+    assert(!cursor.advance(100))
+  })
+
+  it('should write fields in place', function () {
+    var buf = records(2)
+    var cursor = ref.cursor(buf, stride, 2)
+    cursor.next()
+    cursor.writeInt32(-7, 0)
+    cursor.writeDouble(2.5, 8)
+    assert.equal(ref.get(buf, stride, ref.types.int32), -7)
+    assert.equal(ref.get(buf, stride + 8, ref.types.double), 2.5)
+  })
+
+  it('should read and write 64-bit values', function () {
+    var cursor = ref.cursor(Buffer.alloc(8), 8, 1)
+    cursor.writeInt64('-9223372036854775808')
+    assert.equal(cursor.readInt64(), '-9223372036854775808')
+  })
+
+  it('should start from the given offset', function () {
+    var cursor = ref.cursor(records(3), stride, 2, stride)
+    assert.equal(cursor.readInt32(), 2)
+  })
+
+  it('should throw when accessing past the end', function () {
+    var cursor = ref.cursor(records(1), stride, 1)
+    assert.throws(function () {
+      cursor.readDouble(12)
+    }, RangeError)
+    cursor.next()
+    assert.throws(function () {
+      cursor.readInt32()
+    }, RangeError)
+  })
+
+  it('should throw for a negative stride or an overflowing count', function () {
+    assert.throws(function () {
+      ref.cursor(records(1), -stride, 1)
+    }, RangeError)
+    assert.throws(function () {
+      ref.cursor(records(1), stride, Math.pow(2, 62))
+    }, RangeError)
+  })
+
+  it('should throw for a huge field offset', function () {
+    var cursor = ref.cursor(records(1), stride, 1)
+    assert.throws(function () {
+      cursor.readInt32(Math.pow(2, 63))
+    }, RangeError)
+    assert.throws(function () {
+      cursor.readInt32(-Math.pow(2, 63))
+    }, RangeError)
+  })
+
+  it('should throw for a seek or advance that overflows', function () {
+    var cursor = ref.cursor(records(2), stride, 2)
+    assert.throws(function () {
+      cursor.seek(Math.pow(2, 62))
+    }, RangeError)
+    assert.throws(function () {
+      cursor.advance(-Math.pow(2, 62))
+    }, RangeError)
+    // a failed move leaves the cursor where it was
+    assert.equal(cursor.index(), 0)
+    assert.equal(cursor.seek(1), true)
+  })
+
+  it('should report the address of the current element', function () {
+    var buf = records(2)
+    var cursor = ref.cursor(buf, stride, 2)
+    cursor.next()
+    assert.equal(cursor.hexAddress(), ref.hexAddress(buf, stride))
+  })
+
+})
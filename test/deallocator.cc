@@ -0,0 +1,86 @@
+#include <cstdlib>
+
+#include "node.h"
+#include "node_buffer.h"
+#include "nan.h"
+
+/*
+ * A test-only addon providing native deallocators that record their calls,
+ * for `test/owned.js`.
+ */
+
+using namespace v8;
+
+namespace {
+
+int calls = 0;
+void *last_data = NULL;
+void *last_hint = NULL;
+
+void record_free(void *data) {
+  calls++;
+  last_data = data;
+  last_hint = NULL;
+  std::free(data);
+}
+
+void record_free_hint(void *data, void *hint) {
+  calls++;
+  last_data = data;
+  last_hint = hint;
+  std::free(data);
+}
+
+void noop_cb(char *data, void *hint) {
+}
+
+inline Local<Value> WrapAddress(void *ptr) {
+  Nan::EscapableHandleScope scope;
+  return scope.Escape(Nan::NewBuffer(static_cast<char *>(ptr), 0, noop_cb,
+    NULL).ToLocalChecked());
+}
+
+/*
+ * Returns a Buffer viewing "size" bytes from std::malloc() that nothing
+ * owns yet.
+ *
+ * info[0] - Number - the size in bytes of the returned Buffer
+ */
+
+NAN_METHOD(Allocate) {
+  uint32_t size = Nan::To<uint32_t>(info[0]).FromJust();
+  char *ptr = static_cast<char *>(std::malloc(size > 0 ? size : 1));
+  if (ptr == NULL) {
+    return Nan::ThrowError("allocate: out of memory");
+  }
+  info.GetReturnValue().Set(Nan::NewBuffer(ptr, size, noop_cb,
+    NULL).ToLocalChecked());
+}
+
+/*
+ * Returns the number of deallocator calls, and the data and hint addresses
+ * of the last one as zero length Buffers.
+ */
+
+NAN_METHOD(Calls) {
+  Local<Object> rtn = Nan::New<Object>();
+  Nan::Set(rtn, Nan::New("count").ToLocalChecked(), Nan::New(calls));
+  Nan::Set(rtn, Nan::New("data").ToLocalChecked(), WrapAddress(last_data));
+  Nan::Set(rtn, Nan::New("hint").ToLocalChecked(), WrapAddress(last_hint));
+  info.GetReturnValue().Set(rtn);
+}
+
+} // anonymous namespace
+
+NAN_MODULE_INIT(init) {
+  Nan::HandleScope scope;
+
+  Nan::SetMethod(target, "allocate", Allocate);
+  Nan::SetMethod(target, "calls", Calls);
+  Nan::Set(target, Nan::New("free").ToLocalChecked(),
+    WrapAddress(reinterpret_cast<void *>(&record_free)));
+  Nan::Set(target, Nan::New("freeWithHint").ToLocalChecked(),
+    WrapAddress(reinterpret_cast<void *>(&record_free_hint)));
+}
+
+NAN_MODULE_WORKER_ENABLED(test_deallocator, init)
@@ -0,0 +1,32 @@
+var assert = require('assert')
+var createDebug = require('debug')
+var ref = require('../')
+
+describe('debug logging', function () {
+
+  var log = createDebug.log
+  var namespaces
+
+  beforeEach(function () {
+    // returns the namespaces from `DEBUG`, restored afterwards
+    namespaces = createDebug.disable()
+  })
+
+  afterEach(function () {
+    createDebug.enable(namespaces)
+    createDebug.log = log
+  })
+
+  it('should log once "ref" gets enabled after loading', function () {
+    var lines = []
+    createDebug.log = function () {
+      lines.push(arguments)
+    }
+    ref.alloc('int')
+    assert.equal(lines.length, 0)
+    createDebug.enable('ref')
+    ref.alloc('int')
+    assert(lines.length > 0)
+  })
+
+})
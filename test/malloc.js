@@ -0,0 +1,99 @@
+
+var assert = require('assert')
+var ref = require('../')
+
+describe('malloc()', function () {
+
+  it('should return a Buffer of the requested size', function () {
+    var buf = ref.malloc(24)
+    assert(Buffer.isBuffer(buf))
+    assert.equal(buf.length, 24)
+  })
+
+  it('should return an address aligned for any built-in type', function () {
+    var buf = ref.malloc(3)
+    assert.equal(parseInt(buf.hexAddress(), 16) % ref.alignof.double, 0)
+    assert.equal(parseInt(buf.hexAddress(), 16) % ref.alignof.int64, 0)
+  })
+
+  it('should free the memory and zero the length', function () {
+    var buf = ref.malloc(8)
+    ref.free(buf)
+    assert.equal(buf.length, 0)
+  })
+
+  it('should refuse to free a Buffer it did not allocate', function () {
+    assert.throws(function () {
+      ref.free(Buffer.alloc(8))
+    }, TypeError)
+  })
+
+})
+
+describe('alignedAlloc()', function () {
+
+  it('should return a Buffer at an aligned address', function () {
+    var buf = ref.alignedAlloc(10, 64)
+    assert.equal(buf.length, 10)
+    assert.equal(parseInt(buf.hexAddress(), 16) % 64, 0)
+  })
+
+  it('should throw for an alignment that is not a power of 2', function () {
+    assert.throws(function () {
+      ref.alignedAlloc(10, 12)
+    }, RangeError)
+  })
+
+})
+
+describe('Arena', function () {
+
+  it('should hand out typed Buffers with the given value', function () {
+    var arena = new ref.Arena()
+    var buf = arena.alloc(ref.types.int, 42)
+    assert.strictEqual(buf.type, ref.types.int)
+    assert.equal(buf.length, ref.sizeof.int)
+    assert.equal(buf.deref(), 42)
+    arena.destroy()
+  })
+
+  it('should honour the type alignment', function () {
+    var arena = new ref.Arena()
+    arena.alloc(ref.types.char)
+    var buf = arena.alloc(ref.types.double)
+    assert.equal(parseInt(buf.hexAddress(), 16) % ref.alignof.double, 0)
+    arena.destroy()
+  })
+
+  it('should honour an alignment larger than the block alignment', function () {
+    var arena = new ref.Arena()
+    arena.alloc(ref.types.char)
+    var buf = arena.allocBytes(16, 64)
+    assert.equal(buf.length, 16)
+    assert.equal(parseInt(buf.hexAddress(), 16) % 64, 0)
+    arena.reset()
+    arena.allocBytes(3)
+    buf = arena.allocBytes(8, 256)
+    assert.equal(parseInt(buf.hexAddress(), 16) % 256, 0)
+    arena.destroy()
+  })
+
+  it('should reuse its memory after reset()', function () {
+    var arena = new ref.Arena(64)
+    var first = arena.alloc('int64')
+    arena.reset()
+    var second = arena.alloc('int64')
+    assert.equal(first.hexAddress(), second.hexAddress())
+    arena.destroy()
+  })
+
+  it('should grow past the block size', function () {
+    var arena = new ref.Arena(16)
+    var buf = arena.allocBytes(100)
+    assert.equal(buf.length, 100)
+    assert.equal(arena.blocks.length, 1)
+    arena.destroy()
+    assert.equal(buf.length, 0)
+  })
+
+})
@@ -31,6 +31,16 @@ describe('momory-operation', function() {
     assert(gotEx, 'expect get exception - 3')
   })
 
+  it('should throw for containers smaller than a pointer', function() {
+    const container = Buffer.alloc(ref.sizeof.pointer)
+    assert.throws(function() {
+      ref.copyMemory(Buffer.alloc(1), container, 1)
+    }, RangeError)
+    assert.throws(function() {
+      ref.addOffset(Buffer.alloc(1), 1)
+    }, RangeError)
+  })
+
   it('dest buffer should have "abc".', function() {
 
     const src = Buffer.from('abc') 
@@ -66,6 +76,14 @@ describe('momory-operation', function() {
     const value = intBuf.deref() 
     assert(value == 5, 'expect value from pointer be 5') 
   })
+  it('should leave the pointer buffer untouched in readFromPointer', function() {
+    const srcBuf = Buffer.alloc(8)
+    const bufferPointer = ref.alloc(ref.refType(ref.types.void))
+    bufferPointer.writePointer(srcBuf, 0)
+    const address = ref.address(bufferPointer.deref())
+    ref.readFromPointer(bufferPointer, 4, 4)
+    assert.equal(ref.address(bufferPointer.deref()), address)
+  })
 })
 
 // vi: se ts=2 sw=2 et:
@@ -0,0 +1,169 @@
+var assert = require('assert')
+var ref = require('../')
+
+// built by `npm test` only, with `node-gyp rebuild --ref_test=true`
+var deallocator = null
+try {
+  deallocator = require('bindings')('test_deallocator')
+} catch (err) {
+}
+
+/*
+ * Skips the tests needing the test_deallocator addon when it wasn't built.
+ */
+
+function needsDeallocator () {
+  if (!deallocator) {
+    this.skip()
+  }
+}
+
+/*
+ * Node runs the deallocator of a released Buffer from a later turn of the
+ * event loop, so poll until it was called once more than _before_, then hand
+ * the recorded call to _check_.
+ */
+
+function afterDeallocation (before, collect, check, done) {
+  var attempts = 0
+  ;(function poll () {
+    if (collect) {
+      global.gc()
+    }
+    var calls = deallocator.calls()
+    if (calls.count > before) {
+      try {
+        assert.equal(calls.count, before + 1)
+        check(calls)
+      } catch (err) {
+        return done(err)
+      }
+      return done()
+    }
+    if (++attempts === 50) {
+      return done(new Error('the deallocator did not run'))
+    }
+    setTimeout(poll, 10)
+  })()
+}
+
+describe('reinterpretOwned()', function () {
+
+  it('should take over the memory and release it on free()', function (done) {
+    needsDeallocator.call(this)
+    var mem = deallocator.allocate(16)
+    var before = deallocator.calls().count
+    var owned = ref.reinterpretOwned(mem, 16, 0, deallocator.free)
+    assert.equal(owned.length, 16)
+    assert.equal(ref.address(owned), ref.address(mem))
+    ref.free(owned)
+    assert.equal(owned.length, 0)
+    afterDeallocation(before, false, function (calls) {
+      assert.equal(ref.address(calls.data), ref.address(mem))
+    }, done)
+  })
+
+  it('should pass the hint to the deallocator', function (done) {
+    needsDeallocator.call(this)
+    var mem = deallocator.allocate(8)
+    var hint = Buffer.alloc(1)
+    var before = deallocator.calls().count
+    var owned = ref.reinterpretOwned(mem, 8, 0, deallocator.freeWithHint, hint)
+    ref.free(owned)
+    afterDeallocation(before, false, function (calls) {
+      assert.equal(ref.address(calls.data), ref.address(mem))
+      assert.equal(ref.address(calls.hint), ref.address(hint))
+    }, done)
+  })
+
+  it('should default to the C library\'s free()', function () {
+    needsDeallocator.call(this)
+    var owned = ref.reinterpretOwned(deallocator.allocate(8), 8)
+    assert.equal(owned.length, 8)
+    ref.free(owned)
+    assert.equal(owned.length, 0)
+  })
+
+  it('should release the memory once garbage collected', function (done) {
+    needsDeallocator.call(this)
+    if (typeof global.gc !== 'function') {
+      // run with `--expose-gc`
+      return this.skip()
+    }
+    var before = deallocator.calls().count
+    ;(function () {
+      ref.reinterpretOwned(deallocator.allocate(8), 8, 0, deallocator.free)
+    })()
+    afterDeallocation(before, true, function () {}, done)
+  })
+
+  it('should throw for a NULL pointer', function () {
+    assert.throws(function () {
+      ref.reinterpretOwned(ref.NULL, 8)
+    }, Error)
+  })
+
+  it('should throw for a size above the Buffer limit', function () {
+    var buf = Buffer.alloc(8)
+    assert.throws(function () {
+      ref.reinterpretOwned(buf, Math.pow(2, 31))
+    }, RangeError)
+  })
+
+  it('should throw for a deallocator that is not a Buffer', function () {
+    var buf = Buffer.alloc(8)
+    assert.throws(function () {
+      ref.reinterpretOwned(buf, 8, 0, 'free')
+    }, TypeError)
+  })
+
+  it('should throw for a NULL deallocator Buffer', function () {
+    var buf = Buffer.alloc(8)
+    assert.throws(function () {
+      ref.reinterpretOwned(buf, 8, 0, ref.NULL)
+    }, TypeError)
+  })
+
+  it('should throw for a hint without a deallocator', function () {
+    var buf = Buffer.alloc(8)
+    assert.throws(function () {
+      ref.reinterpretOwned(buf, 8, 0, null, Buffer.alloc(1))
+    }, TypeError)
+  })
+
+})
+
+describe('readPointerOwned()', function () {
+
+  it('should take over the memory pointed to', function (done) {
+    needsDeallocator.call(this)
+    var mem = deallocator.allocate(8)
+    var pointer = ref.alloc('pointer')
+    ref.writePointer(pointer, 0, mem)
+    var before = deallocator.calls().count
+    var owned = ref.readPointerOwned(pointer, 0, 8, deallocator.free)
+    assert.equal(owned.length, 8)
+    assert.equal(ref.address(owned), ref.address(mem))
+    ref.free(owned)
+    assert.equal(owned.length, 0)
+    afterDeallocation(before, false, function (calls) {
+      assert.equal(ref.address(calls.data), ref.address(mem))
+    }, done)
+  })
+
+  it('should return a NULL Buffer for a NULL pointer', function () {
+    var pointer = ref.alloc('pointer', ref.NULL)
+    var owned = ref.readPointerOwned(pointer, 0, 4)
+    assert(ref.isNull(owned))
+    assert.equal(owned.length, 0)
+  })
+
+  it('should not let free() release a NULL Buffer', function () {
+    var pointer = ref.alloc('pointer', ref.NULL)
+    var owned = ref.readPointerOwned(pointer, 0, 4)
+    assert.throws(function () {
+      ref.free(owned)
+    }, TypeError)
+  })
+
+})
@@ -0,0 +1,65 @@
+
+var assert = require('assert')
+var ref = require('../')
+
+describe('stats()', function () {
+
+  before(function () {
+    if (ref.stats() === null) {
+      // the addon was built without `--ref_stats=true`
+      this.skip()
+    }
+  })
+
+  beforeEach(function () {
+    ref.resetStats(false)
+  })
+
+  it('should count the calls of each binding', function () {
+    var buf = Buffer.alloc(ref.sizeof.pointer)
+    ref.isNull(buf)
+    ref.isNull(buf)
+    assert.equal(ref.stats().calls.isNull, 2)
+  })
+
+  it('should count the bytes scanned by reinterpretUntilZeros()', function () {
+    var buf = Buffer.from('hello\0')
+    ref.reinterpretUntilZeros(buf, 1)
+    assert.equal(ref.stats().bytesScanned, 6)
+  })
+
+  it('should count the bytes copied by copyMemory()', function () {
+    var src = Buffer.from('abc')
+    var dst = Buffer.alloc(3)
+    var srcContainer = Buffer.alloc(ref.sizeof.pointer)
+    var dstContainer = Buffer.alloc(ref.sizeof.pointer)
+    ref.writePointer(srcContainer, 0, src)
+    ref.writePointer(dstContainer, 0, dst)
+    ref.copyMemory(dstContainer, srcContainer, 3)
+    assert.equal(ref.stats().bytesCopied, 3)
+  })
+
+  it('should track the live wrapped pointers', function () {
+    var before = ref.stats().wrappedPointers
+    var buf = ref.reinterpret(Buffer.alloc(16), 8)
+    var after = ref.stats().wrappedPointers
+    assert.equal(after.live, before.live + 1)
+    assert.equal(after.liveBytes, before.liveBytes + buf.length)
+  })
+
+  it('should count the global handles created by writeObject()', function () {
+    var buf = ref.alloc('Object')
+    ref.writeObject(buf, 0, {})
+    assert.equal(ref.stats().globalHandles.created, 1)
+  })
+
+  it('should record the latency histogram when asked to', function () {
+    assert.equal(ref.stats().latency, undefined)
+    ref.resetStats(true)
+    ref.isNull(Buffer.alloc(1))
+    var latency = ref.stats().latency
+    assert.equal(latency.isNull.reduce(function (a, b) { return a + b }), 1)
+    ref.resetStats(false)
+  })
+
+})
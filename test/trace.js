@@ -0,0 +1,44 @@
+var assert = require('assert')
+var fs = require('fs')
+var os = require('os')
+var path = require('path')
+var spawnSync = require('child_process').spawnSync
+
+describe('trace events', function () {
+
+  var dir
+
+  before(function () {
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ref-trace-'))
+  })
+
+  after(function () {
+    fs.readdirSync(dir).forEach(function (name) {
+      fs.unlinkSync(path.join(dir, name))
+    })
+    fs.rmdirSync(dir)
+  })
+
+  it('should emit native spans in the "ref" category', function () {
+    var script = [
+      'var ref = require(' + JSON.stringify(path.resolve(__dirname, '..')) + ')',
+      'var buf = Buffer.from("hello\\0")',
+      'ref.reinterpretUntilZeros(buf, 1)',
+      'ref.reinterpret(buf, 2)'
+    ].join('\n')
+    var child = spawnSync(process.execPath,
+      [ '--trace-event-categories', 'ref', '-e', script ], { cwd: dir })
+    assert.equal(child.status, 0, String(child.stderr))
+
+    var log = path.join(dir, 'node_trace.1.log')
+    var events = JSON.parse(fs.readFileSync(log, 'utf8')).traceEvents
+    var names = events.filter(function (e) {
+      return e.cat === 'ref'
+    }).map(function (e) {
+      return e.name
+    })
+    assert.notEqual(names.indexOf('reinterpretUntilZeros'), -1)
+    assert.notEqual(names.indexOf('WrapPointer'), -1)
+  })
+
+})
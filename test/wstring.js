@@ -0,0 +1,79 @@
+
+var fs = require('fs')
+var assert = require('assert')
+var ref = require('../')
+
+describe('wide strings', function () {
+
+  describe('readWString()', function () {
+
+    it('should read a UTF-16 string up to the first 0 character', function () {
+      var buf = Buffer.from('hello\0world', 'utf16le')
+      assert.equal(ref.readWString(buf, 0, 2), 'hello')
+    })
+
+    it('should read a UTF-16 string starting from offset', function () {
+      var buf = Buffer.from('hello\0world', 'utf16le')
+      assert.equal(buf.readWString(6, 2), 'world')
+    })
+
+    it('should read a large UTF-16 string', function () {
+      var data = fs.readFileSync(__dirname + '/utf16le.bin')
+      var str = ref.readWString(data, 0, 2)
+      assert.equal(str, ref.reinterpretUntilZeros(data, 2).toString('ucs2'))
+    })
+
+    it('should read a UTF-32 string with astral characters', function () {
+      var buf = Buffer.alloc(16)
+      buf.writeUInt32LE(0x61, 0)
+      buf.writeUInt32LE(0x1F600, 4)
+      buf.writeUInt32LE(0x62, 8)
+      assert.equal(ref.readWString(buf, 0, 4), 'a😀b')
+    })
+
+    it('should throw for an unsupported unit size', function () {
+      assert.throws(function () {
+        ref.readWString(Buffer.alloc(4), 0, 3)
+      }, RangeError)
+    })
+
+  })
+
+  describe('writeWString()', function () {
+
+    it('should write a NUL terminated UTF-16 string', function () {
+      var buf = Buffer.alloc(12, 0xff)
+      ref.writeWString(buf, 0, 'hello', 2)
+      assert.equal(buf.toString('utf16le'), 'hello\0')
+    })
+
+    it('should throw when the string does not fit', function () {
+      assert.throws(function () {
+        ref.writeWString(Buffer.alloc(4), 0, 'hello', 2)
+      }, RangeError)
+    })
+
+  })
+
+  describe('allocWString()', function () {
+
+    it('should round trip through readWString()', function () {
+      var str = 'héllo 😀'
+      var buf = ref.allocWString(str)
+      assert.strictEqual(buf.type.indirection, 2)
+      assert.equal(buf.readWString(0), str)
+    })
+
+    it('should size a UTF-32 string by code points', function () {
+      var buf = ref.allocWString('a😀', 4)
+      assert.equal(buf.length, 3 * 4)
+      assert.equal(ref.readWString(buf, 0, 4), 'a😀')
+    })
+
+    it('should return NULL for null', function () {
+      assert.strictEqual(ref.allocWString(null), ref.NULL)
+    })
+
+  })
+
+})